@@ -0,0 +1,167 @@
+#include "Animator.h"
+
+#define WIPE_DURATION 200
+#define FADE_DURATION 300
+#define PULSE_PERIOD 600
+#define SPINNER_PERIOD 800
+#define ERROR_PULSES 3
+
+Animator::Animator(PixelOutput &output, Clock &clock) : output(output), clock(clock)
+{
+    kind = AnimationNone;
+    color = 0;
+    fromColor = 0;
+    started = 0;
+    duration = 0;
+    repeats = 0;
+}
+
+void Animator::Wipe(uint32_t color, unsigned long duration)
+{
+    Start(AnimationWipe, color, duration);
+}
+
+void Animator::Fade(uint32_t color, unsigned long duration)
+{
+    Start(AnimationFade, color, duration);
+}
+
+void Animator::Pulse(uint32_t color, unsigned long period, uint8_t repeats)
+{
+    Start(AnimationPulse, color, period);
+    this->repeats = repeats;
+}
+
+void Animator::Spinner(uint32_t color, unsigned long period)
+{
+    Start(AnimationSpinner, color, period);
+}
+
+void Animator::Stop()
+{
+    kind = AnimationNone;
+}
+
+void Animator::Start(AnimationKind kind, uint32_t color, unsigned long duration)
+{
+    // the spinner leaves the strip mostly dark for the next fade to start from
+    if (this->kind == AnimationSpinner)
+    {
+        fromColor = 0;
+    }
+    this->kind = kind;
+    this->color = color;
+    this->duration = duration > 0 ? duration : 1;
+    started = clock.Millis();
+    repeats = 0;
+}
+
+void Animator::Update()
+{
+    if (kind == AnimationNone)
+    {
+        return;
+    }
+
+    unsigned long elapsed = clock.Millis() - started;
+    uint16_t count = output.Count();
+    switch (kind)
+    {
+    case AnimationWipe:
+    {
+        uint16_t lit = elapsed >= duration ? count : elapsed * count / duration + 1;
+        for (uint16_t i = 0; i < lit; i++)
+        {
+            output.SetPixel(i, color);
+        }
+        break;
+    }
+    case AnimationFade:
+    {
+        Fill(elapsed >= duration ? color : Blend(fromColor, color, elapsed * 255 / duration));
+        break;
+    }
+    case AnimationPulse:
+    {
+        if (repeats > 0 && elapsed >= duration * repeats)
+        {
+            Fill(0);
+            fromColor = 0;
+            kind = AnimationNone;
+            output.Show();
+            return;
+        }
+        // triangle wave, dark at both ends of a period
+        unsigned long phase = elapsed % duration;
+        unsigned long half = duration / 2 > 0 ? duration / 2 : 1;
+        unsigned long level = phase < half ? phase * 255 / half : (duration - phase) * 255 / half;
+        Fill(Blend(0, color, level > 255 ? 255 : level));
+        break;
+    }
+    case AnimationSpinner:
+    {
+        uint16_t head = (elapsed % duration) * count / duration;
+        for (uint16_t i = 0; i < count; i++)
+        {
+            uint16_t behind = (head + count - i) % count;
+            output.SetPixel(i, behind == 0 ? color : behind == 1 ? Blend(0, color, 64) : 0);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    output.Show();
+
+    // one-off effects hold their last frame, a later fade starts from it
+    if ((kind == AnimationWipe || kind == AnimationFade) && elapsed >= duration)
+    {
+        fromColor = color;
+        kind = AnimationNone;
+    }
+}
+
+void Animator::Fill(uint32_t color)
+{
+    for (uint16_t i = 0; i < output.Count(); i++)
+    {
+        output.SetPixel(i, color);
+    }
+}
+
+uint32_t Animator::Blend(uint32_t from, uint32_t to, uint8_t amount)
+{
+    uint32_t blended = 0;
+    for (uint8_t shift = 0; shift <= 16; shift += 8)
+    {
+        int start = (from >> shift) & 0xFF;
+        int end = (to >> shift) & 0xFF;
+        blended |= (uint32_t)(start + (end - start) * amount / 255) << shift;
+    }
+    return blended;
+}
+
+void ShowStatus(Animator &animator, LedStatus status)
+{
+    switch (status)
+    {
+    case StatusConnecting:
+        animator.Spinner(PixelOutput::Color(122, 122, 0), SPINNER_PERIOD);
+        break;
+    case StatusReady:
+        animator.Fade(PixelOutput::Color(0, 255, 0), FADE_DURATION);
+        break;
+    case StatusReading:
+        animator.Wipe(PixelOutput::Color(0, 0, 255), WIPE_DURATION);
+        break;
+    case StatusPlaying:
+        animator.Wipe(PixelOutput::Color(0, 255, 0), WIPE_DURATION);
+        break;
+    case StatusPaused:
+        animator.Fade(PixelOutput::Color(60, 30, 0), FADE_DURATION);
+        break;
+    case StatusError:
+        animator.Pulse(PixelOutput::Color(255, 0, 0), PULSE_PERIOD, ERROR_PULSES);
+        break;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "PixelOutput.h"
+#include "Clock.h"
+
+enum AnimationKind : uint8_t
+{
+    AnimationNone,
+    AnimationWipe,
+    AnimationFade,
+    AnimationPulse,
+    AnimationSpinner
+};
+
+// What the lights tell the user
+enum LedStatus : uint8_t
+{
+    StatusConnecting,
+    StatusReady,
+    StatusReading,
+    StatusPlaying,
+    StatusPaused,
+    StatusError
+};
+
+// Tweens the strip from one state to the next a tick at a time. Starting an
+// animation only records it, Update() draws the frame for the time passed
+// and is called from the scheduler, so nothing here ever waits.
+class Animator
+{
+public:
+    Animator(PixelOutput &output, Clock &clock = systemClock);
+
+    // lights the strip one pixel after the other
+    void Wipe(uint32_t color, unsigned long duration);
+    // blends the whole strip from the color it settled on over to this one
+    void Fade(uint32_t color, unsigned long duration);
+    // breathes from dark to color and back, repeats 0 keeps going
+    void Pulse(uint32_t color, unsigned long period, uint8_t repeats = 0);
+    // one pixel with a dim tail going round
+    void Spinner(uint32_t color, unsigned long period);
+    void Stop();
+
+    void Update();
+    bool Active() const { return kind != AnimationNone; }
+
+private:
+    PixelOutput &output;
+    Clock &clock;
+    AnimationKind kind;
+    uint32_t color;
+    uint32_t fromColor;
+    unsigned long started;
+    unsigned long duration;
+    uint8_t repeats;
+
+    void Start(AnimationKind kind, uint32_t color, unsigned long duration);
+    void Fill(uint32_t color);
+    static uint32_t Blend(uint32_t from, uint32_t to, uint8_t amount);
+};
+
+void ShowStatus(Animator &animator, LedStatus status);
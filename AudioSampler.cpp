@@ -0,0 +1,39 @@
+#include "AudioSampler.h"
+
+RingBuffer<int16_t, AUDIO_BUFFER_SIZE> AudioSampler::samples;
+uint32_t AudioSampler::lastTick;
+volatile uint32_t AudioSampler::missed;
+
+void AudioSampler::OnTick()
+{
+    uint32_t now = micros();
+    // a tick on time is one interval after the last, round off the jitter
+    uint32_t intervals = (now - lastTick + AUDIO_SAMPLE_INTERVAL * 500) / (AUDIO_SAMPLE_INTERVAL * 1000);
+    if (intervals > 1)
+    {
+        missed = missed + intervals - 1;
+    }
+    lastTick = now;
+    samples.Push(analogRead(A0));
+}
+
+void AudioSampler::Begin()
+{
+    lastTick = micros();
+    ticker.attach_ms(AUDIO_SAMPLE_INTERVAL, OnTick);
+}
+
+void AudioSampler::End()
+{
+    ticker.detach();
+}
+
+bool AudioSampler::Read(int16_t *out, uint16_t count)
+{
+    if (samples.Available() < count)
+    {
+        return false;
+    }
+    samples.Read(out, count);
+    return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Ticker.h>
+#include "RingBuffer.h"
+
+// With WiFi up the ADC cannot be read much more often than this: every
+// analogRead() holds off the radio, and at a few kHz the connection drops.
+// 200 Hz still covers the bass up to 100 Hz, where the beat is, and
+// nothing above it: what the strip shows is a bass meter.
+#define AUDIO_SAMPLE_RATE 200
+#define AUDIO_SAMPLE_INTERVAL (1000 / AUDIO_SAMPLE_RATE)
+// 640 ms of audio, enough to ride out a TLS handshake
+#define AUDIO_BUFFER_SIZE 128
+
+// Samples A0 from a Ticker at AUDIO_SAMPLE_RATE and hands the readings over
+// through a lock-free ring buffer that loop() drains a hop at a time.
+//
+// Ticker callbacks run from the SDK's timer task, between loop() passes and
+// inside delay() and yield(), never in the middle of a flash write. A pass
+// that holds the CPU without yielding, a TLS handshake above all, makes the
+// next sample late, and the ones that fell due while it held on are never
+// taken. Each tick measures the gap since the last one, so those are
+// counted as missed; the audio has a hole there, nothing is made up for it.
+class AudioSampler
+{
+public:
+    void Begin();
+    void End();
+
+    uint16_t Available() const { return samples.Available(); }
+    // copies count samples out, false while fewer are buffered
+    bool Read(int16_t *out, uint16_t count);
+    uint16_t Skip(uint16_t count) { return samples.Skip(count); }
+
+    // samples lost because the buffer was full
+    uint32_t GetOverruns() const { return samples.GetOverruns(); }
+    // samples never taken because the CPU was held when they fell due
+    uint32_t GetMissed() const { return missed; }
+
+private:
+    Ticker ticker;
+    static RingBuffer<int16_t, AUDIO_BUFFER_SIZE> samples;
+    static uint32_t lastTick;
+    static volatile uint32_t missed;
+
+    static void OnTick();
+};
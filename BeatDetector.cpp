@@ -0,0 +1,180 @@
+#include "BeatDetector.h"
+
+BeatDetector::BeatDetector()
+{
+    for (int i = 0; i < BEAT_FLUX_BINS; i++)
+    {
+        previous[i] = 0;
+    }
+    for (int i = 0; i < BEAT_HISTORY; i++)
+    {
+        history[i] = 0;
+    }
+    historyIndex = 0;
+    framesToTempo = BEAT_TEMPO_INTERVAL;
+    fluxMean = 0;
+    fluxDeviation = 0;
+    framesSinceOnset = 0;
+    framesSinceBeat = 0;
+    period = 0;
+    onset = false;
+    onsets = 0;
+    beats = 0;
+}
+
+uint16_t BeatDetector::GetBpm() const
+{
+    if (period == 0)
+    {
+        return 0;
+    }
+    // 60 s * frames per second / frames per beat, the period carries 4 fractional bits
+    return (uint32_t)60 * BEAT_FRAME_RATE_X100 * 16 / 10 / period;
+}
+
+bool BeatDetector::Update(const uint16_t *magnitudes)
+{
+    // only rising energy counts, bin 0 is DC
+    int32_t flux = 0;
+    for (int i = 1; i < BEAT_FLUX_BINS; i++)
+    {
+        if (magnitudes[i] > previous[i])
+        {
+            flux += magnitudes[i] - previous[i];
+        }
+        previous[i] = magnitudes[i];
+    }
+
+    int32_t scaled = flux << 4;
+    int32_t difference = scaled - fluxMean;
+    int32_t threshold = fluxMean + 2 * fluxDeviation + (BEAT_FLUX_FLOOR << 4);
+    fluxMean += difference >> 4;
+    fluxDeviation += ((difference < 0 ? -difference : difference) - fluxDeviation) >> 4;
+
+    // the part above the mean is the onset strength the tempo is found in
+    int32_t strength = difference > 0 ? difference >> 4 : 0;
+    history[historyIndex] = strength > 4095 ? 4095 : strength;
+    historyIndex = (historyIndex + 1) % BEAT_HISTORY;
+    if (--framesToTempo == 0)
+    {
+        framesToTempo = BEAT_TEMPO_INTERVAL;
+        EstimateTempo();
+    }
+
+    framesSinceOnset++;
+    framesSinceBeat++;
+    onset = scaled > threshold && framesSinceOnset >= BEAT_MIN_LAG / 2;
+    if (onset)
+    {
+        onsets++;
+        framesSinceOnset = 0;
+    }
+
+    bool beat;
+    uint32_t sinceBeat = (uint32_t)framesSinceBeat << 4;
+    if (period == 0)
+    {
+        beat = onset;
+        if (beat)
+        {
+            framesSinceBeat = 0;
+        }
+    }
+    else if (onset && sinceBeat >= period * 3 / 4)
+    {
+        // an onset near the expected time pulls the phase onto it
+        beat = true;
+        framesSinceBeat = 0;
+    }
+    else if (sinceBeat >= period * 5 / 4)
+    {
+        // nothing heard, carry on at the tempo
+        beat = true;
+        framesSinceBeat -= period >> 4;
+    }
+    else
+    {
+        beat = false;
+    }
+    if (beat)
+    {
+        beats++;
+    }
+    return beat;
+}
+
+void BeatDetector::EstimateTempo()
+{
+    // one extra lag on each side for the peak interpolation
+    uint32_t correlation[BEAT_MAX_LAG + 2];
+    // correlate the deviations from the mean, or steady noise would
+    // correlate with itself at every lag as well as a beat does
+    uint32_t total = 0;
+    for (int i = 0; i < BEAT_HISTORY; i++)
+    {
+        total += history[i];
+    }
+    int32_t mean = total / BEAT_HISTORY;
+    uint64_t energy = 0;
+    for (int i = 0; i < BEAT_HISTORY; i++)
+    {
+        int32_t deviation = history[i] - mean;
+        energy += (uint32_t)(deviation * deviation);
+    }
+    if (energy == 0)
+    {
+        period = 0;
+        return;
+    }
+
+    int best = 0;
+    for (int lag = BEAT_MIN_LAG - 1; lag <= BEAT_MAX_LAG + 1; lag++)
+    {
+        int64_t sum = 0;
+        for (int i = lag; i < BEAT_HISTORY; i++)
+        {
+            sum += (int32_t)(history[(historyIndex + i) % BEAT_HISTORY] - mean) * (history[(historyIndex + i - lag) % BEAT_HISTORY] - mean);
+        }
+        // longer lags overlap fewer frames, scale them back up
+        sum = sum * BEAT_HISTORY / (BEAT_HISTORY - lag);
+        correlation[lag] = sum < 0 ? 0 : sum > 0xFFFFFFFF ? 0xFFFFFFFF : sum;
+        if (lag >= BEAT_MIN_LAG && lag <= BEAT_MAX_LAG && (best == 0 || correlation[lag] > correlation[best]))
+        {
+            best = lag;
+        }
+    }
+
+    // no clear periodicity, a quarter of the energy at lag 0 at least
+    if (correlation[best] < energy / 4)
+    {
+        period = 0;
+        return;
+    }
+
+    // a beat at twice the period correlates as well as the beat itself, take
+    // the faster tempo when its peak is at least half as strong
+    int half = (best + 1) / 2;
+    if (half - 1 >= BEAT_MIN_LAG)
+    {
+        int candidate = half;
+        for (int lag = half - 1; lag <= half + 1; lag++)
+        {
+            if (correlation[lag] > correlation[candidate])
+            {
+                candidate = lag;
+            }
+        }
+        if (correlation[candidate] >= correlation[best] / 2)
+        {
+            best = candidate;
+        }
+    }
+
+    // a beat between two frames splits its correlation over the neighbouring
+    // lags in proportion, their centroid recovers the fractional lag
+    uint64_t left = correlation[best - 1];
+    uint64_t center = correlation[best];
+    uint64_t right = correlation[best + 1];
+    int32_t offset = (int32_t)(((int64_t)right - (int64_t)left) * 16 / (int64_t)(left + center + right));
+    period = (best << 4) + offset;
+}
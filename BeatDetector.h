@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+
+// FFT frames per second times 100, 200 Hz / a hop of 8 samples
+#define BEAT_FRAME_RATE_X100 2500
+// bins summed into the flux, all of them: at 200 Hz they reach 100 Hz, the kick drum
+#define BEAT_FLUX_BINS 16
+// onset strength kept for the tempo estimate, about 5 s
+#define BEAT_HISTORY 128
+// tempo range in frames between beats, 187 down to 60 BPM
+#define BEAT_MIN_LAG 8
+#define BEAT_MAX_LAG 25
+// frames between tempo estimates, the autocorrelation is the costly part
+#define BEAT_TEMPO_INTERVAL 16
+// flux below this never counts, keeps hiss from triggering
+#define BEAT_FLUX_FLOOR 40
+
+// Finds onsets in the spectrum stream by spectral energy flux against an
+// adaptive mean plus deviation threshold, estimates the tempo from the
+// autocorrelation of the onset strength and locks beats onto it. Beats
+// keep coming at the tempo through a missed onset or two. Integer only.
+class BeatDetector
+{
+public:
+    BeatDetector();
+
+    // once per FFT frame with its bin magnitudes, true on a beat
+    bool Update(const uint16_t *magnitudes);
+
+    bool Onset() const { return onset; }
+    // beats per minute times 10, 0 while the tempo is unknown
+    uint16_t GetBpm() const;
+    unsigned long GetOnsets() const { return onsets; }
+    unsigned long GetBeats() const { return beats; }
+
+private:
+    uint16_t previous[BEAT_FLUX_BINS];
+    uint16_t history[BEAT_HISTORY];
+    uint8_t historyIndex;
+    uint8_t framesToTempo;
+    // running mean and mean deviation of the flux, 4 fractional bits
+    int32_t fluxMean;
+    int32_t fluxDeviation;
+    uint16_t framesSinceOnset;
+    uint16_t framesSinceBeat;
+    // frames per beat with 4 fractional bits, 0 while unknown
+    uint16_t period;
+    bool onset;
+    unsigned long onsets;
+    unsigned long beats;
+
+    void EstimateTempo();
+};
@@ -0,0 +1,95 @@
+#include "CardDetector.h"
+
+volatile bool CardDetector::answered = false;
+
+void IRAM_ATTR CardDetector::OnIrq()
+{
+    answered = true;
+}
+
+CardDetector::CardDetector(MFRC522 &mfrc522, int8_t irqPin, unsigned long interval, Clock &clock)
+    : mfrc522(mfrc522), clock(clock)
+{
+    this->irqPin = irqPin;
+    this->interval = interval;
+    lastPoll = 0;
+    transactions = 0;
+    armed = false;
+}
+
+void CardDetector::Begin()
+{
+    if (irqPin < 0)
+    {
+        return;
+    }
+    pinMode(irqPin, INPUT_PULLUP);
+    mfrc522.PCD_WriteRegister(MFRC522::ComIEnReg, MFRC522_IRQ_RX);
+    transactions++;
+    attachInterrupt(digitalPinToInterrupt(irqPin), OnIrq, FALLING);
+}
+
+bool CardDetector::Poll(bool &seen)
+{
+    if (irqPin < 0 || !armed)
+    {
+        if (clock.Millis() - lastPoll < interval)
+        {
+            return false;
+        }
+        lastPoll = clock.Millis();
+        if (irqPin < 0)
+        {
+            seen = WakeAndSelect();
+            return true;
+        }
+        Arm();
+        return false;
+    }
+
+    if (!answered && clock.Millis() - lastPoll < CARD_ANSWER_TIMEOUT)
+    {
+        return false;
+    }
+    armed = false;
+
+    // a card that answered the WUPA is READY and can be selected right away
+    seen = answered;
+    if (seen)
+    {
+        seen = mfrc522.PICC_ReadCardSerial();
+        transactions++;
+    }
+    return true;
+}
+
+bool CardDetector::WakeAndSelect()
+{
+    byte atqa[2];
+    byte atqaSize = sizeof(atqa);
+    MFRC522::StatusCode result = mfrc522.PICC_WakeupA(atqa, &atqaSize);
+    transactions++;
+    if (result != MFRC522::STATUS_OK && result != MFRC522::STATUS_COLLISION)
+    {
+        return false;
+    }
+    transactions++;
+    return mfrc522.PICC_ReadCardSerial();
+}
+
+// Leaves a WUPA in flight, the IRQ pin reports the answer
+void CardDetector::Arm()
+{
+    // the library's own exchanges leave RxIRq set and the pin low, clear it so the answer makes an edge
+    mfrc522.PCD_WriteRegister(MFRC522::CommandReg, MFRC522::PCD_Idle);
+    mfrc522.PCD_WriteRegister(MFRC522::ComIrqReg, MFRC522_IRQ_CLEAR);
+    answered = false;
+    // an exchange cut short leaves bytes in the FIFO, they would go out in front of the WUPA
+    mfrc522.PCD_WriteRegister(MFRC522::FIFOLevelReg, MFRC522_FIFO_FLUSH);
+    mfrc522.PCD_ClearRegisterBitMask(MFRC522::CollReg, MFRC522_VALUES_AFTER_COLL);
+    mfrc522.PCD_WriteRegister(MFRC522::FIFODataReg, MFRC522::PICC_CMD_WUPA);
+    mfrc522.PCD_WriteRegister(MFRC522::CommandReg, MFRC522::PCD_Transceive);
+    mfrc522.PCD_WriteRegister(MFRC522::BitFramingReg, MFRC522_SHORT_FRAME_SEND);
+    transactions += 7;
+    armed = true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Arduino.h>
+#include "MFRC522.h"
+#include "Clock.h"
+
+// ComIEnReg: IRQ pin active low, raised when the reader received an answer
+#define MFRC522_IRQ_RX 0xA0
+// ComIrqReg: writing with Set1 cleared clears every pending request
+#define MFRC522_IRQ_CLEAR 0x7F
+// FIFOLevelReg: FlushBuffer
+#define MFRC522_FIFO_FLUSH 0x80
+// CollReg: ValuesAfterColl, cleared as the library does before every REQA and WUPA
+#define MFRC522_VALUES_AFTER_COLL 0x80
+// BitFramingReg: StartSend with a 7 bit short frame, as REQA and WUPA are sent
+#define MFRC522_SHORT_FRAME_SEND 0x87
+// a card answers WUPA within microseconds, this only bounds the wait for none
+#define CARD_ANSWER_TIMEOUT 2
+
+// Tells when a card sits on the reader. With an IRQ pin the reader is only
+// told to send WUPA every interval and the answer is picked up from the pin,
+// so only CollReg is read back over SPI while the field is empty and loop()
+// does not wait on the exchange. Without a pin (irqPin < 0) each interval runs a
+// blocking WUPA instead.
+class CardDetector
+{
+public:
+    CardDetector(MFRC522 &mfrc522, int8_t irqPin, unsigned long interval, Clock &clock = systemClock);
+
+    void Begin();
+
+    // True once per interval, seen tells whether a card answered and was
+    // selected. The card is left selected for the caller to read and halt.
+    bool Poll(bool &seen);
+
+    // commands sent to the reader, a register write or a PICC exchange each
+    unsigned long GetTransactions() const { return transactions; }
+
+private:
+    MFRC522 &mfrc522;
+    Clock &clock;
+    int8_t irqPin;
+    unsigned long interval;
+    unsigned long lastPoll;
+    unsigned long transactions;
+    bool armed;
+
+    static volatile bool answered;
+    static void IRAM_ATTR OnIrq();
+
+    bool WakeAndSelect();
+    void Arm();
+};
@@ -0,0 +1,3 @@
+#include "Clock.h"
+
+SystemClock systemClock;
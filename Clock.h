@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Time source for SpotifyClient, swapped for a fake one to exercise expiry
+class Clock
+{
+public:
+    virtual unsigned long Millis() = 0;
+};
+
+class SystemClock : public Clock
+{
+public:
+    unsigned long Millis() override { return millis(); }
+};
+
+extern SystemClock systemClock;
@@ -0,0 +1,96 @@
+#include <Arduino.h>
+#include "ColorTable.h"
+
+// hue of the quietest level, 170 of 256 is blue; the loudest is 0, red
+#define AMPLITUDE_HUE_RANGE 170
+
+struct GammaTable
+{
+    uint8_t values[GAMMA_TABLE_SIZE];
+};
+
+struct AmplitudeTable
+{
+    uint32_t colors[AMPLITUDE_TABLE_SIZE];
+};
+
+static constexpr double SquareRoot(double x)
+{
+    double root = x > 1 ? x : 1;
+    for (int i = 0; i < 32; i++)
+    {
+        root = (root + x / root) / 2;
+    }
+    return root;
+}
+
+// x^2.5 as x^2 * sqrt(x), std::pow is not constexpr
+static constexpr GammaTable MakeGammaTable()
+{
+    GammaTable table{};
+    for (int i = 0; i < GAMMA_TABLE_SIZE; i++)
+    {
+        double x = i / 255.0;
+        table.values[i] = (uint8_t)(x * x * SquareRoot(x) * 255 + 0.5);
+    }
+    return table;
+}
+
+static constexpr GammaTable gammaTable PROGMEM = MakeGammaTable();
+
+// Integer HSV to RGB over six 43 step sectors of an 8 bit hue circle
+static constexpr uint32_t Hsv(uint8_t hue, uint8_t saturation, uint8_t value, const GammaTable &gamma)
+{
+    uint8_t sector = hue / 43;
+    uint8_t remainder = (hue - sector * 43) * 6;
+    uint8_t p = (value * (255 - saturation)) >> 8;
+    uint8_t q = (value * (255 - ((saturation * remainder) >> 8))) >> 8;
+    uint8_t t = (value * (255 - ((saturation * (255 - remainder)) >> 8))) >> 8;
+    uint8_t r = 0, g = 0, b = 0;
+    switch (sector)
+    {
+    case 0:
+        r = value, g = t, b = p;
+        break;
+    case 1:
+        r = q, g = value, b = p;
+        break;
+    case 2:
+        r = p, g = value, b = t;
+        break;
+    case 3:
+        r = p, g = q, b = value;
+        break;
+    case 4:
+        r = t, g = p, b = value;
+        break;
+    default:
+        r = value, g = p, b = q;
+        break;
+    }
+    return ((uint32_t)gamma.values[r] << 16) | ((uint32_t)gamma.values[g] << 8) | gamma.values[b];
+}
+
+static constexpr AmplitudeTable MakeAmplitudeTable()
+{
+    AmplitudeTable table{};
+    constexpr GammaTable gamma = MakeGammaTable();
+    for (int level = 0; level < AMPLITUDE_TABLE_SIZE; level++)
+    {
+        uint8_t hue = AMPLITUDE_HUE_RANGE - level * AMPLITUDE_HUE_RANGE / 255;
+        table.colors[level] = Hsv(hue, 255, level, gamma);
+    }
+    return table;
+}
+
+static constexpr AmplitudeTable amplitudeTable PROGMEM = MakeAmplitudeTable();
+
+uint8_t Gamma8(uint8_t value)
+{
+    return pgm_read_byte(&gammaTable.values[value]);
+}
+
+uint32_t AmplitudeColor(uint8_t level)
+{
+    return pgm_read_dword(&amplitudeTable.colors[level]);
+}
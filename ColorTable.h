@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+
+#define GAMMA_TABLE_SIZE 256
+#define AMPLITUDE_TABLE_SIZE 256
+
+// Tables generated by the compiler and kept in flash (PROGMEM), so turning
+// a level into a pixel color is a single lookup per pixel.
+
+// gamma 2.5 corrected channel value
+uint8_t Gamma8(uint8_t value);
+
+// Level 0-255 to a packed 0xRRGGBB color: hue sweeps from blue when quiet to
+// red when loud, value follows the level, both gamma corrected. The strip's
+// own channel order (GRB) is left to the output backend.
+uint32_t AmplitudeColor(uint8_t level);
@@ -0,0 +1,156 @@
+#include <Arduino.h>
+#include "ConnectionPool.h"
+
+// A session BearSSL never filled in has no id
+static bool SessionEmpty(BearSSL::Session &session)
+{
+    return session.getSession()->session_id_len == 0;
+}
+
+static bool SameSession(BearSSL::Session &a, BearSSL::Session &b)
+{
+    br_ssl_session_parameters *first = a.getSession();
+    br_ssl_session_parameters *second = b.getSession();
+    return first->session_id_len == second->session_id_len && memcmp(first->session_id, second->session_id, first->session_id_len) == 0;
+}
+
+ConnectionPool::ConnectionPool()
+{
+    api.host = SPOTIFY_API_HOST;
+    accounts.host = SPOTIFY_ACCOUNTS_HOST;
+    reused = false;
+    hits = 0;
+    misses = 0;
+    fullHandshakes = 0;
+    resumedHandshakes = 0;
+    sessionStore = nullptr;
+    handshaking = nullptr;
+
+    api.client.setInsecure();
+    accounts.client.setInsecure();
+    api.client.setSession(&api.session);
+    accounts.client.setSession(&accounts.session);
+}
+
+void ConnectionPool::SetSessionStore(fs::FS *fs)
+{
+    sessionStore = fs;
+    if (sessionStore)
+    {
+        LoadSession(api);
+        LoadSession(accounts);
+    }
+}
+
+PooledConnection &ConnectionPool::Acquire(const char *host)
+{
+    PooledConnection &connection = strcmp(host, accounts.host) == 0 ? accounts : api;
+
+    reused = connection.client.connected();
+    if (reused)
+    {
+        hits++;
+    }
+    else
+    {
+        misses++;
+
+        // not enough heap for two BearSSL contexts, give up the idle session
+        PooledConnection &other = Other(connection);
+        if (other.client.connected() && ESP.getMaxFreeBlockSize() < MIN_FREE_BLOCK_FOR_SECOND_SESSION)
+        {
+            Serial.print("Closing idle connection to ");
+            Serial.println(other.host);
+            other.client.stop();
+        }
+
+        // remember what we offer so the outcome of the handshake can be told apart
+        handshaking = &connection;
+        offeredSession = connection.session;
+    }
+    return connection;
+}
+
+bool ConnectionPool::Connect(PooledConnection &connection)
+{
+    if (connection.client.connected())
+    {
+        return true;
+    }
+    // DNS, TCP and the TLS handshake block, the pool exists to make this rare
+    return connection.client.connect(connection.host, 443);
+}
+
+void ConnectionPool::Release(PooledConnection &connection)
+{
+    // the socket stays open for the next request
+    CountHandshake(connection);
+}
+
+void ConnectionPool::Reset(PooledConnection &connection)
+{
+    if (handshaking == &connection)
+    {
+        handshaking = nullptr;
+    }
+    connection.client.stop();
+}
+
+void ConnectionPool::CountHandshake(PooledConnection &connection)
+{
+    if (handshaking != &connection)
+    {
+        return;
+    }
+    handshaking = nullptr;
+
+    // the server only echoes back the session id we offered when it resumed
+    if (!SessionEmpty(offeredSession) && SameSession(offeredSession, connection.session))
+    {
+        resumedHandshakes++;
+        return;
+    }
+
+    fullHandshakes++;
+    SaveSession(connection);
+}
+
+void ConnectionPool::LoadSession(PooledConnection &connection)
+{
+    String path = String("/tls_") + connection.host;
+    File file = sessionStore->open(path, "r");
+    if (!file)
+    {
+        return;
+    }
+    if (file.size() == sizeof(br_ssl_session_parameters))
+    {
+        file.read(reinterpret_cast<uint8_t *>(connection.session.getSession()), sizeof(br_ssl_session_parameters));
+    }
+    file.close();
+}
+
+void ConnectionPool::SaveSession(PooledConnection &connection)
+{
+    if (!sessionStore || SessionEmpty(connection.session))
+    {
+        return;
+    }
+    String path = String("/tls_") + connection.host;
+    File file = sessionStore->open(path, "w");
+    if (!file)
+    {
+        return;
+    }
+    file.write(reinterpret_cast<const uint8_t *>(connection.session.getSession()), sizeof(br_ssl_session_parameters));
+    file.close();
+}
+
+PooledConnection &ConnectionPool::Other(PooledConnection &connection)
+{
+    if (&connection == &api)
+    {
+        return accounts;
+    }
+    return api;
+}
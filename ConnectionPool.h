@@ -0,0 +1,58 @@
+#pragma once
+
+#include <WiFiClientSecure.h>
+#include <FS.h>
+
+// Below this largest free heap block a second TLS session is not kept open,
+// the idle one is closed first so the new handshake has room for its buffers.
+#define MIN_FREE_BLOCK_FOR_SECOND_SESSION 24000
+
+#define SPOTIFY_API_HOST "api.spotify.com"
+#define SPOTIFY_ACCOUNTS_HOST "accounts.spotify.com"
+
+struct PooledConnection
+{
+    const char *host;
+    WiFiClientSecure client;
+    BearSSL::Session session;
+};
+
+// Keeps one kept-alive HTTPS session per Spotify host and hands out the
+// matching connection for every request. When a socket has to be reopened
+// the cached TLS session lets BearSSL do an abbreviated handshake.
+class ConnectionPool
+{
+public:
+    ConnectionPool();
+
+    PooledConnection &Acquire(const char *host);
+    bool Connect(PooledConnection &connection);
+    void Release(PooledConnection &connection);
+    void Reset(PooledConnection &connection);
+
+    void SetSessionStore(fs::FS *fs);
+
+    bool Reused() const { return reused; }
+    unsigned long GetHits() const { return hits; }
+    unsigned long GetMisses() const { return misses; }
+    unsigned long GetFullHandshakes() const { return fullHandshakes; }
+    unsigned long GetResumedHandshakes() const { return resumedHandshakes; }
+
+private:
+    PooledConnection api;
+    PooledConnection accounts;
+    bool reused;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long fullHandshakes;
+    unsigned long resumedHandshakes;
+
+    fs::FS *sessionStore;
+    PooledConnection *handshaking;
+    BearSSL::Session offeredSession;
+
+    PooledConnection &Other(PooledConnection &connection);
+    void CountHandshake(PooledConnection &connection);
+    void LoadSession(PooledConnection &connection);
+    void SaveSession(PooledConnection &connection);
+};
@@ -1,38 +1,91 @@
 #include <WiFiManager.h>
 
 #include <ESP8266WiFi.h>
+#include <LittleFS.h>
 
 // RGB Strip Import
-#include <Adafruit_NeoPixel.h>
 #define NUM_LEDS 8
+#include "StripGeometry.h"
+// ring of NUM_LEDS, effects start one pixel in as the sound meter always did
+typedef StripGeometry<NUM_LEDS, StripRing, 1> LedGeometry;
+#define LED_FPS 30
+#define LED_BRIGHTNESS 50
+#define LED_BACKEND_BITBANG 0 // Adafruit_NeoPixel on LED_PIN, interrupts off for every frame
+#define LED_BACKEND_DMA 1     // NeoPixelBus I2S DMA, strip data on GPIO3 (RX)
+#define LED_BACKEND_UART 2    // NeoPixelBus UART1, strip data on GPIO2 (TX1)
+#ifndef LED_BACKEND
+#define LED_BACKEND LED_BACKEND_BITBANG
+#endif
+#if LED_BACKEND == LED_BACKEND_BITBANG
+#include <Adafruit_NeoPixel.h>
+#include "NeoPixelOutput.h"
 #define LED_PIN 4
 Adafruit_NeoPixel pixels(NUM_LEDS, LED_PIN, NEO_GRB + NEO_KHZ800);
+NeoPixelOutput leds(pixels);
+#else
+#include "NeoPixelBusOutput.h"
+#if LED_BACKEND == LED_BACKEND_DMA
+typedef NeoEsp8266Dma800KbpsMethod LedMethod;
+#else
+typedef NeoEsp8266AsyncUart1800KbpsMethod LedMethod;
+#endif
+NeoPixelBus<NeoGrbFeature, LedMethod> pixels(NUM_LEDS);
+NeoPixelBusOutput<LedMethod> leds(pixels);
+#endif
+#include "LedRenderer.h"
+#include "Animator.h"
+#define ANIMATION_INTERVAL 20
+static_assert(NUM_LEDS <= RENDERER_MAX_PIXELS, "Raise RENDERER_MAX_PIXELS for this strip");
+LedRenderer renderer(leds, LED_FPS);
+StripLayout<LedGeometry, LedRenderer> layout(renderer);
+Animator animator(layout);
 
 // Reactive lights setup
+#include "AudioSampler.h"
+#include "Spectrum.h"
+#include "BeatDetector.h"
+#include "SoundReactive.h"
 #define ANALOG_READ A0
-int leds_h[NUM_LEDS];
-int mic_in; //TODO Change variabl
-long actual_time = 0;
-int reactive_idx;
+#define SOUND_INTERVAL 10 // a new hop of samples is ready every 40 ms
+AudioSampler audioSampler;
+Spectrum spectrum;
+BeatDetector beatDetector;
+int16_t audio_frame[FFT_SIZE];
+uint8_t audio_bands[SPECTRUM_BANDS];
+SoundReactive soundReactive;
+static_assert(SPECTRUM_BANDS == SOUND_BANDS, "The display shows every band of the spectrum");
 
 // RC522 SETTINGS
 #include <SPI.h>
 #include "MFRC522.h"
+#include "CardDetector.h"
+#include "NfcReader.h"
+#include "TagCache.h"
+#include "TagParser.h"
+#include "TagPresence.h"
 #define RST_PIN 0                 // Configurable
 #define SS_PIN 15                 // Configurable
+#define IRQ_PIN 5                 // MFRC522 IRQ, -1 polls with a blocking WUPA instead
+#define TAG_POLL_INTERVAL 100     // ms between presence polls
+#define PAUSE_ON_REMOVE false     // pause playback when the card is taken off
 MFRC522 mfrc522(SS_PIN, RST_PIN); // Create MFRC522 instance
-MFRC522::StatusCode status;       //variable to get card status
-byte size = 18;
-uint8_t pageAddr = 0x06;
-byte const BUFFERSiZE = 176;
-byte buffer_[18];
-byte c1[96];
+CardDetector cardDetector(mfrc522, IRQ_PIN, TAG_POLL_INTERVAL);
+NfcReader nfc(mfrc522);
+TagCache tagCache;
+TagPresence tagPresence;
+
+// Scheduler and loop statistics
+#include "Scheduler.h"
+Scheduler scheduler;
+#define STATS_INTERVAL 10000
+unsigned long stats_start = 0;
+unsigned long loop_busy_us = 0;
+unsigned long stats_transactions = 0;
 
 // WIFI SETTINGS
 // const char *ssid = "Dorne WIFI 6";
 // const char *password = "dorne1234";
-unsigned long previous_time = 0;
-unsigned long delay_time = 20000; // 20 seconds delay
+#define WIFI_CHECK_INTERVAL 20000 // 20 seconds delay
 
 // SPOTIFY API SETTINGS
 #include "SpotifyClient.h"
@@ -41,150 +94,312 @@ String clientId = "ed6b1e55817049ff92eb6048532d00d8";
 String clientSecret = "cc7e29ef07254c229403d090d1da7c83";
 String deviceName = "Echo en la Glasgow";
 SpotifyClient spotify = SpotifyClient(clientId, clientSecret, deviceName, refreshToken);
+#include "PlaybackPoller.h"
+#define PLAYER_CHECK_INTERVAL 250 // how often the poller looks whether a poll is due
+PlaybackPoller player(spotify);
 
 void setup()
 {
     // MIC Setup
     pinMode(ANALOG_READ, INPUT);
 
-    // RGB Strip setup
-    pixels.begin();
-    pixels.clear();
-    pixels.setBrightness(50);
-    pixels.show();
-
     // Serial Setup
     Serial.begin(115200);
 
+    // RGB Strip setup, after Serial as the DMA backend takes over the RX pin
+    leds.Begin(LED_BRIGHTNESS);
+
     // Connect Wifi
     // WiFi.begin(ssid, password);
     // Serial.print("Connecting");
     // connectWifi();
 
     //first parameter is name of access point, second is the password
-    loadColor(122, 122, 0);
+    ShowStatus(animator, StatusConnecting);
+    drawNow();
     WiFiManager wifiManager;
     wifiManager.setClass("invert"); // dark theme
     wifiManager.autoConnect("AutoConnectAP", "password");
 
-    // Connect to Spotify
-    spotify.FetchToken();
-    spotify.GetDevices();
-    loadColor(0, 255, 0);
+    // Connect to Spotify, reusing the token, device and TLS sessions of a previous boot
+    if (LittleFS.begin())
+    {
+        spotify.SetStore(&LittleFS);
+        tagCache.SetStore(&LittleFS);
+    }
+    bool warm = spotify.HasToken() && spotify.HasDevice();
+    if (!spotify.HasToken())
+        spotify.FetchToken();
+    if (!spotify.HasDevice())
+        spotify.GetDevices();
+    ShowStatus(animator, StatusReady);
+    Serial.print(warm ? "Warm" : "Cold");
+    Serial.print(" boot ready after ");
+    Serial.print(millis());
+    Serial.println(" ms");
 
     // Start the NFC reader
     SPI.begin();
     mfrc522.PCD_Init();
+    cardDetector.Begin();
+
+    // Start sampling the microphone
+    audioSampler.Begin();
+
+    // budgets in us, runs over them show up as overruns in the stats
+    bool scheduled = true;
+    scheduled &= scheduler.Every("wifi", WIFI_CHECK_INTERVAL, checkWifi) >= 0;
+    scheduled &= scheduler.Every("sound", SOUND_INTERVAL, updateSound, 2000) >= 0;
+    scheduled &= scheduler.Every("spotify", 0, []
+                                 { spotify.Loop(); },
+                                 20000) >= 0;
+    scheduled &= scheduler.Every("card", 0, pollCard, 20000) >= 0;
+    scheduled &= scheduler.Every("player", PLAYER_CHECK_INTERVAL, updatePlayer, 1000) >= 0;
+    scheduled &= scheduler.Every("animation", ANIMATION_INTERVAL, []
+                                 { animator.Update(); },
+                                 1000) >= 0;
+    scheduled &= scheduler.Every("leds", 0, []
+                                 { renderer.Update(); },
+                                 1000) >= 0;
+    scheduled &= scheduler.Every("stats", STATS_INTERVAL, reportStats) >= 0;
+    // a task that did not fit would silently never run
+    if (!scheduled)
+    {
+        Serial.println("Scheduler table full, raise SCHEDULER_MAX_TASKS");
+        ShowStatus(animator, StatusError);
+    }
 }
 
 void loop()
 {
-    // WIFI Reconection
-    unsigned long current_time = millis(); // number of milliseconds since the upload
-    if ((current_time - previous_time >= delay_time))
+    unsigned long loop_start = micros();
+    scheduler.Run();
+    loop_busy_us += micros() - loop_start;
+
+    // nothing in flight, give the CPU to the WiFi stack's modem sleep until the next tick
+    if (spotify.Idle())
+        delay(1);
+}
+
+// WIFI Reconection
+void checkWifi()
+{
+    if (WiFi.status() != WL_CONNECTED)
     {
-        if (WiFi.status() != WL_CONNECTED)
-        {
-            Serial.print(millis());
-            Serial.println("Reconnecting to WIFI network");
-            WiFi.disconnect();
-            WiFi.reconnect();
-            previous_time = current_time;
-        }
+        Serial.print(millis());
+        Serial.println("Reconnecting to WIFI network");
+        WiFi.disconnect();
+        WiFi.reconnect();
     }
+}
 
-    // Sound Reactive
-    if (millis() - actual_time > 35)
+// Sound Reactive
+void updateSound()
+{
+    // the frame slides along a hop at a time, after a long task only the
+    // newest whole frame is worth showing
+    uint16_t hop = FFT_HOP;
+    if (audioSampler.Available() >= FFT_SIZE)
     {
-        actual_time = millis();
-        mic_in = analogRead(A0) / 4;
+        audioSampler.Skip(audioSampler.Available() - FFT_SIZE);
+        hop = FFT_SIZE;
+    }
+    else if (audioSampler.Available() < FFT_HOP)
+        return;
+    memmove(audio_frame, audio_frame + hop, (FFT_SIZE - hop) * sizeof(int16_t));
+    audioSampler.Read(audio_frame + FFT_SIZE - hop, hop);
+    spectrum.Analyze(audio_frame, audio_bands);
+    soundReactive.Bands(audio_bands);
+    if (beatDetector.Update(spectrum.GetMagnitudes()))
+        soundReactive.Beat();
+    // status feedback goes first, the bass meter fills the strip in between
+    if (!animator.Active())
+        soundReactive.Render(layout);
+}
 
-        for (int i = 0; i < ((NUM_LEDS / 2) - 1); i++)
-        {
-            leds_h[i] = leds_h[i + 1];
-            leds_h[NUM_LEDS - 1 - i] = leds_h[(NUM_LEDS)-i - 2];
-        }
+// Playback State
+void updatePlayer()
+{
+    switch (player.Update())
+    {
+    case PlaybackTrackChanged:
+    case PlaybackResumed:
+        Serial.print("Now playing ");
+        Serial.println(spotify.GetPlayback().trackId);
+        ShowStatus(animator, spotify.GetPlayback().playing ? StatusPlaying : StatusPaused);
+        break;
+    case PlaybackPaused:
+    case PlaybackStopped:
+        ShowStatus(animator, StatusPaused);
+        break;
+    default:
+        break;
     }
-    leds_h[(NUM_LEDS / 2) - 1] = mic_in;
-    leds_h[NUM_LEDS / 2] = mic_in;
+}
 
-    for (int i = 0; i < NUM_LEDS; i++)
+// Check for a card, halted cards answer WUPA so one left on the reader is seen on every poll
+void pollCard()
+{
+    bool seen;
+    if (cardDetector.Poll(seen))
+        handleCard(seen);
+}
+
+void handleCard(bool seen)
+{
+    TagEvent event = tagPresence.Update(seen ? mfrc522.uid.uidByte : nullptr, mfrc522.uid.size);
+    if (event == TagInserted)
+    {
+        // a half read card gets another go on the next poll
+        if (!Read())
+            tagPresence.Forget();
+    }
+    else if (event == TagRemoved)
+    {
+        Serial.print("Card removed, suppressed duplicate taps: ");
+        Serial.println(tagPresence.GetSuppressed());
+        if (PAUSE_ON_REMOVE)
+            spotify.PauseAsync();
+    }
+    if (seen)
     {
-        reactive_idx = i + 1;
-        if (reactive_idx > NUM_LEDS - 1)
-            reactive_idx -= 8;
-        // pixels.setPixelColorHsv(reactive_idx, map(leds_h[i], 100, 200, 0, 255), 255, 255);
+        mfrc522.PICC_HaltA();
+        mfrc522.PCD_StopCrypto1();
     }
-    pixels.show();
+}
 
-    // Check for new card
-    if (!mfrc522.PICC_IsNewCardPresent())
-        return;
-    if (!mfrc522.PICC_ReadCardSerial())
-        return;
-    Read();
+void reportStats()
+{
+    unsigned long elapsed = millis() - stats_start;
+    unsigned long transactions = cardDetector.GetTransactions() + nfc.GetTotalTransactions();
+    Serial.print("Loop duty ");
+    Serial.print(loop_busy_us / (elapsed * 10));
+    Serial.print("%, reader transactions/s ");
+    Serial.println((transactions - stats_transactions) * 1000 / elapsed);
+    Serial.print("LED frames pushed ");
+    Serial.print(renderer.GetFramesPushed());
+    Serial.print(", skipped ");
+    Serial.print(renderer.GetFramesSkipped());
+    Serial.print(", CPU per frame avg ");
+    Serial.print(renderer.GetAveragePushMicros());
+    Serial.print(" us, max ");
+    Serial.print(renderer.GetMaxPushMicros());
+    Serial.println(" us");
+    Serial.print("Audio samples lost to overruns ");
+    Serial.print(audioSampler.GetOverruns());
+    Serial.print(", missed while blocked ");
+    Serial.print(audioSampler.GetMissed());
+    Serial.print(", tempo ");
+    Serial.print(beatDetector.GetBpm() / 10);
+    Serial.print(" BPM, beats ");
+    Serial.println(beatDetector.GetBeats());
+    Serial.print("Player polls ");
+    Serial.print(player.GetPolls());
+    Serial.print(", not modified ");
+    Serial.print(player.GetNotModified());
+    Serial.print(", errors ");
+    Serial.print(player.GetErrors());
+    Serial.print(", next in ");
+    Serial.print(player.GetInterval());
+    Serial.println(" ms");
+    Serial.print("Spotify connections reused ");
+    Serial.print(spotify.GetConnectionHits());
+    Serial.print(", opened ");
+    Serial.print(spotify.GetConnectionMisses());
+    Serial.print(", TLS handshakes full ");
+    Serial.print(spotify.GetFullHandshakes());
+    Serial.print(", resumed ");
+    Serial.println(spotify.GetResumedHandshakes());
+    scheduler.PrintStats(Serial);
+    scheduler.ResetStats();
+    stats_start = millis();
+    loop_busy_us = 0;
+    stats_transactions = transactions;
 }
 
-void Read() // Read data
+bool Read() // Read data, false when the tag could not be read and is worth another go
 {
-    loadColor(0, 0, 255);
+    ShowStatus(animator, StatusReading);
 
     Serial.println(F("Reading data ... "));
 
-    //data in 4 block is read at once.
-    for (int i = 0; i < 6; i++)
+    // a known card only has to prove it was not rewritten
+    unsigned long read_start = millis();
+    String context_uri;
+    TagCacheEntry *cached = tagCache.Find(mfrc522.uid.uidByte, mfrc522.uid.size);
+    if (cached)
     {
-        status = mfrc522.MIFARE_Read(pageAddr + (4 * i), buffer_, &size);
-        if (status != MFRC522::STATUS_OK)
+        uint32_t checksum;
+        if (nfc.ReadCheckSum(cached->checkPage, checksum) && checksum == cached->checksum)
         {
-            Serial.print("MIFARE_Read() failed: ");
-            Serial.println(mfrc522.GetStatusCodeName(status));
-
-            delay(100);
+            tagCache.Hit(*cached);
+            context_uri = cached->uri;
+        }
+        else
+        {
+            tagCache.Invalidate(*cached);
+        }
+    }
 
-            mfrc522.PICC_HaltA();
-            mfrc522.PCD_StopCrypto1();
-            return;
+    // otherwise only the pages holding the NDEF message are read
+    if (context_uri.length() == 0)
+    {
+        NfcResult result = nfc.Read();
+        if (result == NfcReadError)
+        {
+            Serial.println("Tag read failed");
+            return false;
+        }
+        if (result == NfcNoMessage)
+        {
+            // an empty or foreign card stays empty, reading it again on every poll would not help
+            Serial.println("No NDEF message on tag");
+        }
+        else
+        {
+            context_uri = parseNFCTagData(nfc.GetMessage(), nfc.GetMessageLength());
+            if (context_uri.length() > 0)
+                tagCache.Store(mfrc522.uid.uidByte, mfrc522.uid.size, nfc.GetCheckPage(), nfc.GetCheckSum(), context_uri.c_str());
         }
-        for (byte j = 0; j < 16; j++)
-            c1[j + i * 16] = buffer_[j];
     }
+    Serial.print("Tag read in ");
+    Serial.print(millis() - read_start);
+    Serial.print(" ms, ");
+    Serial.print(nfc.GetTransactions());
+    Serial.print(" transactions, cache hits ");
+    Serial.print(tagCache.GetHits());
+    Serial.print("/");
+    Serial.println(tagCache.GetHits() + tagCache.GetMisses());
 
     // Playing uri
-    String context_uri = parseNFCTagData(c1);
-    Serial.println(context_uri);
-    spotify.PlaySpotifyUri(context_uri);
-    loadColor(0, 255, 0);
-
-    mfrc522.PICC_HaltA();
-    mfrc522.PCD_StopCrypto1();
+    if (context_uri.length() > 0)
+    {
+        spotify.PlaySpotifyUriAsync(context_uri, [](int httpCode)
+                                    {
+                                        ShowStatus(animator, httpCode >= 200 && httpCode < 300 ? StatusPlaying : StatusError);
+                                        player.Poke(); });
+    }
+    else
+    {
+        ShowStatus(animator, StatusError);
+    }
+    return true;
 }
 
-void loadColor(int r, int g, int b)
+// For setup(), which blocks before the scheduler runs
+void drawNow()
 {
-    for (int i = 0; i < NUM_LEDS; i++)
-    {
-        pixels.setPixelColor(i, pixels.Color(r, g, b));
-        pixels.show();
-        delay(50);
-    }
+    animator.Update();
+    renderer.Flush();
 }
 
 void connectWifi()
 {
-    int led_idx = 0;
+    ShowStatus(animator, StatusConnecting);
     //Check WiFi connection status
     while (WiFi.status() != WL_CONNECTED)
     {
-        pixels.clear();
-
-        pixels.setPixelColor(led_idx, pixels.Color(122, 122, 0));
-        led_idx++;
-        if (led_idx >= NUM_LEDS)
-        {
-            led_idx = 0;
-        }
-        pixels.show();
+        drawNow();
 
         delay(300);
         Serial.print(".");
@@ -192,25 +407,16 @@ void connectWifi()
     Serial.println("\n Connected");
 }
 
-String parseNFCTagData(byte *dataBuffer)
+String parseNFCTagData(const byte *dataBuffer, size_t size)
 {
-    String retVal = "spotify:";
-    for (int i = 26; i < BUFFERSiZE; i++)
+    char uri[128];
+    if (!ParseTagUri(dataBuffer, size, uri, sizeof(uri)))
     {
-        if (dataBuffer[i] == 0xFE || dataBuffer[i] == 0x00)
-        {
-            break;
-        }
-        if (dataBuffer[i] == '/')
-        {
-            retVal += ':';
-        }
-        else
-        {
-            retVal += (char)dataBuffer[i];
-        }
+        Serial.println("No Spotify link on tag");
+        return String();
     }
+    String retVal = uri;
     Serial.print("NFC tag: ");
     Serial.println(retVal);
     return retVal;
-}
\ No newline at end of file
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Non-allocating string with room for Capacity characters, used to build
+// requests without touching the heap. Appends that do not fit are dropped
+// and remembered in Overflowed().
+template <size_t Capacity>
+class FixedString
+{
+public:
+    FixedString() { Clear(); }
+    FixedString(const char *text)
+    {
+        Clear();
+        Append(text);
+    }
+
+    void Clear()
+    {
+        length = 0;
+        overflowed = false;
+        buffer[0] = '\0';
+    }
+
+    // Drops everything after count characters, undoing appends that overflowed
+    void Truncate(size_t count)
+    {
+        if (count < length)
+        {
+            length = count;
+            buffer[length] = '\0';
+        }
+        overflowed = false;
+    }
+
+    FixedString &Append(const char *text, size_t count)
+    {
+        if (count > Capacity - length)
+        {
+            count = Capacity - length;
+            overflowed = true;
+        }
+        memcpy(buffer + length, text, count);
+        length += count;
+        buffer[length] = '\0';
+        return *this;
+    }
+
+    FixedString &Append(const char *text)
+    {
+        return Append(text, strlen(text));
+    }
+
+    FixedString &Append(char c)
+    {
+        return Append(&c, 1);
+    }
+
+    FixedString &AppendNumber(unsigned long value)
+    {
+        char digits[11];
+        uint8_t count = 0;
+        do
+        {
+            digits[sizeof(digits) - 1 - count++] = '0' + value % 10;
+            value /= 10;
+        } while (value > 0);
+        return Append(digits + sizeof(digits) - count, count);
+    }
+
+    template <size_t Other>
+    FixedString &Append(const FixedString<Other> &text)
+    {
+        return Append(text.c_str(), text.Length());
+    }
+
+    const char *c_str() const { return buffer; }
+    size_t Length() const { return length; }
+    bool Overflowed() const { return overflowed; }
+
+private:
+    char buffer[Capacity + 1];
+    size_t length;
+    bool overflowed;
+};
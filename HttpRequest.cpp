@@ -0,0 +1,374 @@
+#include "HttpRequest.h"
+
+// Case insensitive check that line starts with the lower case prefix
+static bool HeaderIs(const char *line, const char *prefix)
+{
+    for (; *prefix; line++, prefix++)
+    {
+        if (tolower(*line) != *prefix)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+HttpRequest::HttpRequest(ConnectionPool &connections) : connections(connections)
+{
+    connection = nullptr;
+    state = Idle;
+    httpCode = 0;
+    pipelined = false;
+    followUpSent = false;
+}
+
+void HttpRequest::Begin(const char *method, const char *host, const char *path, const char *scheme, const char *credentials, const char *contentType, const char *body, Stream *sink, const char *ifNoneMatch)
+{
+    this->method = method;
+    this->host = host;
+    this->sink = sink;
+    payload.Clear();
+    httpCode = 0;
+    retried = false;
+    pipelined = false;
+    followUpSent = false;
+
+    request.Clear();
+    AppendRequest(method, path, scheme, credentials, contentType, body, ifNoneMatch);
+
+    state = Connecting;
+}
+
+bool HttpRequest::Pipeline(const char *method, const char *path, const char *scheme, const char *credentials, const char *contentType, const char *body)
+{
+    size_t first = request.Length();
+    AppendRequest(method, path, scheme, credentials, contentType, body, nullptr);
+    if (request.Overflowed())
+    {
+        // no room, the follow-up goes out on its own later
+        request.Truncate(first);
+        return false;
+    }
+    pipelined = true;
+    return true;
+}
+
+void HttpRequest::AppendRequest(const char *method, const char *path, const char *scheme, const char *credentials, const char *contentType, const char *body, const char *ifNoneMatch)
+{
+    request.Append(method).Append(' ').Append(path).Append(" HTTP/1.1\r\nHost: ").Append(host);
+    request.Append("\r\nAuthorization: ").Append(scheme).Append(' ').Append(credentials);
+    request.Append("\r\nContent-Type: ").Append(contentType);
+    if (ifNoneMatch && ifNoneMatch[0] != '\0')
+    {
+        request.Append("\r\nIf-None-Match: ").Append(ifNoneMatch);
+    }
+    request.Append("\r\nContent-Length: ").AppendNumber(strlen(body));
+    request.Append("\r\nConnection: keep-alive\r\n\r\n").Append(body);
+}
+
+void HttpRequest::ContinuePipelined(const char *method, Stream *sink)
+{
+    this->method = method;
+    this->sink = sink;
+    payload.Clear();
+    httpCode = 0;
+    // the request already went out, there is nothing left to retry with
+    retried = true;
+    pipelined = false;
+    followUpSent = false;
+    StartReading();
+}
+
+bool HttpRequest::Step()
+{
+    if (state == Connecting)
+    {
+        return StepConnect();
+    }
+    if (Busy())
+    {
+        return StepRead();
+    }
+    return false;
+}
+
+bool HttpRequest::StepConnect()
+{
+    if (request.Overflowed())
+    {
+        Serial.println("Request too long, not sent");
+        httpCode = HTTP_ERROR_SEND_FAILED;
+        state = Failed;
+        return false;
+    }
+
+    connection = &connections.Acquire(host);
+    if (!connections.Connect(*connection))
+    {
+        Serial.print("Failed to connect to ");
+        Serial.println(host);
+        Fail(HTTP_ERROR_CONNECTION_FAILED);
+        return false;
+    }
+
+    if (connection->client.write((const uint8_t *)request.c_str(), request.Length()) != request.Length())
+    {
+        if (!Retry())
+        {
+            Fail(HTTP_ERROR_SEND_FAILED);
+        }
+        return Busy();
+    }
+
+    followUpSent = pipelined;
+    StartReading();
+    return true;
+}
+
+void HttpRequest::StartReading()
+{
+    state = ReadingStatus;
+    etag.Clear();
+    lineLength = 0;
+    received = false;
+    lastActivity = millis();
+}
+
+// A kept-alive socket the server already closed only shows up once used, try once more on a fresh one
+bool HttpRequest::Retry()
+{
+    if (retried || received || !connections.Reused())
+    {
+        return false;
+    }
+    Serial.println("stale connection, retrying");
+    retried = true;
+    connections.Reset(*connection);
+    state = Connecting;
+    return true;
+}
+
+bool HttpRequest::StepRead()
+{
+    WiFiClientSecure &client = connection->client;
+    int budget = HTTP_STEP_BUDGET;
+
+    while (budget > 0 && Busy())
+    {
+        int available = client.available();
+        if (available <= 0)
+        {
+            if (!client.connected())
+            {
+                if (state == ReadingBody && untilClose)
+                {
+                    Finish();
+                }
+                else if (!Retry())
+                {
+                    Fail(HTTP_ERROR_CONNECTION_LOST);
+                }
+            }
+            else if (millis() - lastActivity > HTTP_TIMEOUT)
+            {
+                Fail(HTTP_ERROR_TIMEOUT);
+            }
+            break;
+        }
+
+        received = true;
+        lastActivity = millis();
+
+        if (state == ReadingBody)
+        {
+            // a read takes at most a buffer's worth, count what it took
+            int consumed = ReadBody(min(available, budget));
+            if (consumed <= 0)
+            {
+                break;
+            }
+            budget -= consumed;
+            continue;
+        }
+
+        char c = (char)client.read();
+        budget--;
+        if (c == '\n')
+        {
+            line[lineLength] = '\0';
+            lineLength = 0;
+            HandleLine();
+        }
+        else if (c != '\r' && lineLength < HTTP_LINE_SIZE - 1)
+        {
+            line[lineLength++] = c;
+        }
+    }
+    return Busy();
+}
+
+void HttpRequest::HandleLine()
+{
+    switch (state)
+    {
+    case ReadingStatus:
+        // "HTTP/1.1 200 OK"
+        httpCode = atoi(line + 9);
+        chunked = false;
+        keepAlive = true;
+        untilClose = false;
+        remaining = -1;
+        state = ReadingHeaders;
+        break;
+    case ReadingHeaders:
+        if (line[0] == '\0')
+        {
+            EndOfHeaders();
+        }
+        else
+        {
+            HandleHeader();
+        }
+        break;
+    case ReadingChunkSize:
+        remaining = strtol(line, nullptr, 16);
+        state = remaining > 0 ? ReadingBody : ReadingTrailer;
+        break;
+    case ReadingChunkEnd:
+        state = ReadingChunkSize;
+        break;
+    case ReadingTrailer:
+        if (line[0] == '\0')
+        {
+            Finish();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void HttpRequest::HandleHeader()
+{
+    if (HeaderIs(line, "content-length:"))
+    {
+        remaining = atol(line + 15);
+    }
+    else if (HeaderIs(line, "transfer-encoding:"))
+    {
+        chunked = strstr(line, "chunked") != nullptr;
+    }
+    else if (HeaderIs(line, "connection:"))
+    {
+        keepAlive = strstr(line, "close") == nullptr;
+    }
+    else if (HeaderIs(line, "etag:"))
+    {
+        const char *value = line + 5;
+        while (*value == ' ')
+        {
+            value++;
+        }
+        etag.Clear();
+        // a tag cut short by the line buffer would never match, drop it
+        if (strlen(line) < HTTP_LINE_SIZE - 1)
+        {
+            etag.Append(value);
+        }
+        if (etag.Overflowed())
+        {
+            etag.Clear();
+        }
+    }
+}
+
+void HttpRequest::EndOfHeaders()
+{
+    if (httpCode == 204 || httpCode == 304 || strcmp(method, "HEAD") == 0)
+    {
+        Finish();
+    }
+    else if (chunked)
+    {
+        state = ReadingChunkSize;
+    }
+    else if (remaining == 0)
+    {
+        Finish();
+    }
+    else
+    {
+        // no length at all, the body runs until the server closes
+        untilClose = remaining < 0;
+        keepAlive = keepAlive && !untilClose;
+        state = ReadingBody;
+    }
+}
+
+int HttpRequest::ReadBody(int available)
+{
+    uint8_t buffer[128];
+    if (!untilClose && available > remaining)
+    {
+        available = remaining;
+    }
+    if (available > (int)sizeof(buffer))
+    {
+        available = sizeof(buffer);
+    }
+
+    int length = connection->client.read(buffer, available);
+    if (length <= 0)
+    {
+        return 0;
+    }
+    if (sink)
+    {
+        sink->write(buffer, length);
+    }
+    else
+    {
+        payload.Append((const char *)buffer, length);
+    }
+
+    if (untilClose)
+    {
+        return length;
+    }
+    remaining -= length;
+    if (remaining == 0)
+    {
+        if (chunked)
+        {
+            state = ReadingChunkEnd;
+        }
+        else
+        {
+            Finish();
+        }
+    }
+    return length;
+}
+
+void HttpRequest::Finish()
+{
+    state = Done;
+    // a server closing after the first response drops the pipelined one
+    followUpSent = followUpSent && keepAlive;
+    if (keepAlive)
+    {
+        connections.Release(*connection);
+    }
+    else
+    {
+        connections.Reset(*connection);
+    }
+}
+
+void HttpRequest::Fail(int code)
+{
+    httpCode = code;
+    state = Failed;
+    followUpSent = false;
+    connections.Reset(*connection);
+}
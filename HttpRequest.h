@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Arduino.h>
+#include "ConnectionPool.h"
+#include "FixedString.h"
+
+// Give up on a response when nothing arrives for this long
+#define HTTP_TIMEOUT 10000
+// Bytes handled per Step() so the caller's loop() keeps its cadence
+#define HTTP_STEP_BUDGET 512
+#define HTTP_LINE_SIZE 96
+// Room for two requests written back to back, see Pipeline()
+#define HTTP_REQUEST_SIZE 1536
+// Bodies not sent to a sink are only kept for logging, longer ones are cut
+#define HTTP_PAYLOAD_SIZE 256
+// Longer entity tags are not kept, the request simply goes out unconditional
+#define HTTP_ETAG_SIZE 64
+
+// Negative result codes, in the spirit of HTTPClient's HTTPC_ERROR_*
+#define HTTP_ERROR_CONNECTION_FAILED -1
+#define HTTP_ERROR_SEND_FAILED -2
+#define HTTP_ERROR_CONNECTION_LOST -3
+#define HTTP_ERROR_TIMEOUT -4
+#define HTTP_ERROR_QUEUE_FULL -5
+
+// One HTTP/1.1 exchange on a pooled connection, advanced a little at a time
+// by Step() instead of blocking until the whole response is in. The body is
+// written to sink when one is given, otherwise collected in payload.
+// Pipeline() sends a second request in the same write; once the first
+// response is done ContinuePipelined() reads the second one. Passing the
+// ETag of an earlier response as ifNoneMatch makes the request conditional,
+// an unchanged resource then comes back as a bodiless 304.
+class HttpRequest
+{
+public:
+    HttpRequest(ConnectionPool &connections);
+
+    void Begin(const char *method, const char *host, const char *path, const char *scheme, const char *credentials, const char *contentType, const char *body, Stream *sink, const char *ifNoneMatch = nullptr);
+    bool Pipeline(const char *method, const char *path, const char *scheme, const char *credentials, const char *contentType, const char *body);
+    void ContinuePipelined(const char *method, Stream *sink);
+    bool Step();
+    bool Busy() const { return state != Idle && state != Done && state != Failed; }
+
+    bool FollowUpSent() const { return followUpSent; }
+    int GetHttpCode() const { return httpCode; }
+    const char *GetPayload() const { return payload.c_str(); }
+    const char *GetETag() const { return etag.c_str(); }
+
+private:
+    enum State : uint8_t
+    {
+        Idle,
+        Connecting,
+        ReadingStatus,
+        ReadingHeaders,
+        ReadingBody,
+        ReadingChunkSize,
+        ReadingChunkEnd,
+        ReadingTrailer,
+        Done,
+        Failed
+    };
+
+    ConnectionPool &connections;
+    PooledConnection *connection;
+    State state;
+    bool retried;
+    bool chunked;
+    bool keepAlive;
+    bool untilClose;
+    bool received;
+    bool pipelined;
+    bool followUpSent;
+    int httpCode;
+    long remaining;
+    unsigned long lastActivity;
+
+    const char *method;
+    const char *host;
+    FixedString<HTTP_REQUEST_SIZE> request;
+    Stream *sink;
+    FixedString<HTTP_PAYLOAD_SIZE> payload;
+    FixedString<HTTP_ETAG_SIZE> etag;
+
+    char line[HTTP_LINE_SIZE];
+    uint8_t lineLength;
+
+    void AppendRequest(const char *method, const char *path, const char *scheme, const char *credentials, const char *contentType, const char *body, const char *ifNoneMatch);
+    void StartReading();
+    bool StepConnect();
+    bool StepRead();
+    bool Retry();
+    void HandleLine();
+    void HandleHeader();
+    void EndOfHeaders();
+    int ReadBody(int available);
+    void Finish();
+    void Fail(int code);
+};
@@ -0,0 +1,315 @@
+#include "JsonStreamParser.h"
+
+JsonStreamParser::JsonStreamParser(JsonListener &listener) : listener(listener)
+{
+    Reset();
+}
+
+void JsonStreamParser::Reset()
+{
+    state = Scan;
+    escaped = false;
+    hexDigits = 0;
+    codeUnit = 0;
+    highSurrogate = 0;
+    expectKey = false;
+    depth = 0;
+    arrayLevels = 0;
+    key[0] = '\0';
+    keyLength = 0;
+    valueLength = 0;
+}
+
+size_t JsonStreamParser::write(const uint8_t *buffer, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        write(buffer[i]);
+    }
+    return size;
+}
+
+size_t JsonStreamParser::write(uint8_t c)
+{
+    switch (state)
+    {
+    case InKey:
+    case InString:
+        StringChar((char)c);
+        break;
+    case InLiteral:
+        if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            Emit();
+            state = Scan;
+            ScanChar((char)c);
+        }
+        else if (valueLength < JSON_VALUE_SIZE - 1)
+        {
+            value[valueLength++] = (char)c;
+        }
+        break;
+    default:
+        ScanChar((char)c);
+        break;
+    }
+    return 1;
+}
+
+void JsonStreamParser::ScanChar(char c)
+{
+    switch (c)
+    {
+    case '{':
+        Open(false);
+        break;
+    case '[':
+        Open(true);
+        break;
+    case '}':
+    case ']':
+        Close();
+        break;
+    case ',':
+        expectKey = !InArray();
+        break;
+    case ':':
+        expectKey = false;
+        break;
+    case '"':
+        if (expectKey)
+        {
+            state = InKey;
+            keyLength = 0;
+        }
+        else
+        {
+            state = InString;
+            valueLength = 0;
+        }
+        break;
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+        break;
+    default:
+        // numbers, true, false and null
+        state = InLiteral;
+        value[0] = c;
+        valueLength = 1;
+        break;
+    }
+}
+
+static int HexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+void JsonStreamParser::StringChar(char c)
+{
+    if (hexDigits > 0)
+    {
+        int digit = HexValue(c);
+        if (digit < 0)
+        {
+            // a broken \u escape is dropped, the character is taken as it is
+            hexDigits = 0;
+        }
+        else
+        {
+            codeUnit = (codeUnit << 4) | digit;
+            if (--hexDigits == 0)
+            {
+                CodeUnit(codeUnit);
+            }
+            return;
+        }
+    }
+
+    if (escaped)
+    {
+        escaped = false;
+        switch (c)
+        {
+        case 'u':
+            hexDigits = 4;
+            codeUnit = 0;
+            return;
+        case 'n':
+            c = '\n';
+            break;
+        case 't':
+            c = '\t';
+            break;
+        case 'r':
+            c = '\r';
+            break;
+        case 'b':
+            c = '\b';
+            break;
+        case 'f':
+            c = '\f';
+            break;
+        default:
+            break;
+        }
+    }
+    else if (c == '\\')
+    {
+        escaped = true;
+        return;
+    }
+    else if (c == '"')
+    {
+        FlushSurrogate();
+        if (state == InKey)
+        {
+            key[keyLength] = '\0';
+        }
+        else
+        {
+            Emit();
+        }
+        state = Scan;
+        return;
+    }
+
+    FlushSurrogate();
+    Put(c);
+}
+
+void JsonStreamParser::Put(char c)
+{
+    if (state == InKey)
+    {
+        if (keyLength < JSON_KEY_SIZE - 1)
+        {
+            key[keyLength++] = c;
+        }
+    }
+    else if (valueLength < JSON_VALUE_SIZE - 1)
+    {
+        value[valueLength++] = c;
+    }
+}
+
+// UTF-16 from a \u escape, a character outside the BMP comes as a surrogate pair
+void JsonStreamParser::CodeUnit(uint16_t unit)
+{
+    if (unit >= 0xD800 && unit < 0xDC00)
+    {
+        FlushSurrogate();
+        highSurrogate = unit;
+        return;
+    }
+    uint32_t codePoint = unit;
+    if (unit >= 0xDC00 && unit < 0xE000)
+    {
+        codePoint = highSurrogate ? 0x10000 + ((uint32_t)(highSurrogate - 0xD800) << 10) + (unit - 0xDC00) : 0xFFFD;
+        highSurrogate = 0;
+    }
+    FlushSurrogate();
+    PutUtf8(codePoint);
+}
+
+// a high surrogate nothing paired with becomes U+FFFD
+void JsonStreamParser::FlushSurrogate()
+{
+    if (highSurrogate)
+    {
+        highSurrogate = 0;
+        PutUtf8(0xFFFD);
+    }
+}
+
+// Only whole sequences go in, a truncated value never ends in half a character
+void JsonStreamParser::PutUtf8(uint32_t codePoint)
+{
+    char bytes[4];
+    uint8_t count;
+    if (codePoint < 0x80)
+    {
+        bytes[0] = (char)codePoint;
+        count = 1;
+    }
+    else if (codePoint < 0x800)
+    {
+        bytes[0] = (char)(0xC0 | (codePoint >> 6));
+        bytes[1] = (char)(0x80 | (codePoint & 0x3F));
+        count = 2;
+    }
+    else if (codePoint < 0x10000)
+    {
+        bytes[0] = (char)(0xE0 | (codePoint >> 12));
+        bytes[1] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        bytes[2] = (char)(0x80 | (codePoint & 0x3F));
+        count = 3;
+    }
+    else
+    {
+        bytes[0] = (char)(0xF0 | (codePoint >> 18));
+        bytes[1] = (char)(0x80 | ((codePoint >> 12) & 0x3F));
+        bytes[2] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        bytes[3] = (char)(0x80 | (codePoint & 0x3F));
+        count = 4;
+    }
+
+    size_t room = state == InKey ? JSON_KEY_SIZE - 1 - keyLength : JSON_VALUE_SIZE - 1 - valueLength;
+    if (count > room)
+    {
+        return;
+    }
+    for (uint8_t i = 0; i < count; i++)
+    {
+        Put(bytes[i]);
+    }
+}
+
+void JsonStreamParser::Open(bool array)
+{
+    const char *containerKey = CurrentKey();
+    if (depth < JSON_MAX_DEPTH)
+    {
+        depth++;
+    }
+    if (array)
+    {
+        arrayLevels |= 1UL << depth;
+    }
+    else
+    {
+        arrayLevels &= ~(1UL << depth);
+    }
+    expectKey = !array;
+    listener.StartContainer(containerKey, depth);
+}
+
+void JsonStreamParser::Close()
+{
+    listener.EndContainer(depth);
+    if (depth > 0)
+    {
+        depth--;
+    }
+    expectKey = false;
+}
+
+void JsonStreamParser::Emit()
+{
+    value[valueLength] = '\0';
+    listener.Value(CurrentKey(), value, depth);
+}
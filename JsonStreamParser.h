@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define JSON_KEY_SIZE 32
+#define JSON_VALUE_SIZE 384
+#define JSON_MAX_DEPTH 31
+
+// Receives the scalars of a JSON document as they stream past. Keys of array
+// elements are reported as "". The root object is depth 1.
+class JsonListener
+{
+public:
+    virtual void Value(const char *key, const char *value, uint8_t depth) = 0;
+    virtual void StartContainer(const char *key, uint8_t depth) {}
+    virtual void EndContainer(uint8_t depth) {}
+};
+
+// SAX style tokenizer that is written to like any other Stream, so
+// HttpRequest::ReadBody() can hand it a response body chunk by chunk as it
+// comes off the socket, without the body ever being held in memory. Values
+// longer than JSON_VALUE_SIZE are truncated. \uXXXX escapes are decoded to
+// UTF-8.
+class JsonStreamParser : public Stream
+{
+public:
+    JsonStreamParser(JsonListener &listener);
+
+    void Reset();
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+
+private:
+    enum State : uint8_t
+    {
+        Scan,
+        InKey,
+        InString,
+        InLiteral
+    };
+
+    JsonListener &listener;
+    State state;
+    bool escaped;
+    // hex digits of a \uXXXX escape still to come
+    uint8_t hexDigits;
+    uint16_t codeUnit;
+    uint16_t highSurrogate;
+    bool expectKey;
+    uint8_t depth;
+    uint32_t arrayLevels;
+    char key[JSON_KEY_SIZE];
+    char value[JSON_VALUE_SIZE];
+    uint8_t keyLength;
+    uint16_t valueLength;
+
+    void ScanChar(char c);
+    void StringChar(char c);
+    void Put(char c);
+    void CodeUnit(uint16_t unit);
+    void FlushSurrogate();
+    void PutUtf8(uint32_t codePoint);
+    void Open(bool array);
+    void Close();
+    void Emit();
+    bool InArray() const { return arrayLevels & (1UL << depth); }
+    const char *CurrentKey() const { return InArray() ? "" : key; }
+};
@@ -0,0 +1,74 @@
+#include "LedRenderer.h"
+
+LedRenderer::LedRenderer(PixelOutput &output, uint8_t fps, Clock &clock)
+    : output(output), clock(clock)
+{
+    count = output.Count() > RENDERER_MAX_PIXELS ? RENDERER_MAX_PIXELS : output.Count();
+    frameInterval = 1000 / (fps > 0 ? fps : 1);
+    lastPush = 0;
+    dirty = false;
+    pending = false;
+    framesPushed = 0;
+    framesSkipped = 0;
+    pushMicros = 0;
+    maxPushMicros = 0;
+    for (uint16_t i = 0; i < RENDERER_MAX_PIXELS; i++)
+    {
+        frame[i] = 0;
+    }
+}
+
+void LedRenderer::Clear()
+{
+    for (uint16_t i = 0; i < count; i++)
+    {
+        SetPixel(i, 0);
+    }
+}
+
+void LedRenderer::Show()
+{
+    // an unchanged frame, or one folded into the frame still waiting for its slot
+    if (!dirty || pending)
+    {
+        framesSkipped++;
+        return;
+    }
+    pending = true;
+}
+
+void LedRenderer::Update()
+{
+    if (pending && clock.Millis() - lastPush >= frameInterval)
+    {
+        Push();
+    }
+}
+
+void LedRenderer::Flush()
+{
+    if (dirty)
+    {
+        Push();
+    }
+}
+
+void LedRenderer::Push()
+{
+    unsigned long start = micros();
+    for (uint16_t i = 0; i < count; i++)
+    {
+        output.SetPixel(i, frame[i]);
+    }
+    output.Show();
+    unsigned long elapsed = micros() - start;
+    pushMicros += elapsed;
+    if (elapsed > maxPushMicros)
+    {
+        maxPushMicros = elapsed;
+    }
+    lastPush = clock.Millis();
+    dirty = false;
+    pending = false;
+    framesPushed++;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "PixelOutput.h"
+#include <Arduino.h>
+#include "Clock.h"
+
+// enough for a 60 pixel ring
+#define RENDERER_MAX_PIXELS 64
+
+// Framebuffer in front of the strip. Effects draw on it like on any other
+// PixelOutput, but Show() only marks a frame as wanted: Update() pushes it
+// to the strip when a pixel really changed and no sooner than the frame rate
+// allows. On the bit-banged backend a WS2812 frame holds interrupts off for
+// its whole wire time, so the frames that are not sent are time handed back
+// to WiFi; with DMA or the async UART a frame only costs its encoding.
+class LedRenderer final : public PixelOutput
+{
+public:
+    LedRenderer(PixelOutput &output, uint8_t fps, Clock &clock = systemClock);
+
+    uint16_t Count() const override { return count; }
+    void SetPixel(uint16_t index, uint32_t color) override
+    {
+        if (index < count && frame[index] != color)
+        {
+            frame[index] = color;
+            dirty = true;
+        }
+    }
+    void Show() override;
+
+    void Clear();
+    void Update();
+    // pushes a changed frame right away, for code that still blocks between frames
+    void Flush();
+
+    unsigned long GetFramesPushed() const { return framesPushed; }
+    unsigned long GetFramesSkipped() const { return framesSkipped; }
+    // CPU time spent handing a frame to the strip, the cost of the output backend
+    unsigned long GetAveragePushMicros() const { return framesPushed ? pushMicros / framesPushed : 0; }
+    unsigned long GetMaxPushMicros() const { return maxPushMicros; }
+
+private:
+    PixelOutput &output;
+    Clock &clock;
+    uint16_t count;
+    uint32_t frame[RENDERER_MAX_PIXELS];
+    unsigned long frameInterval;
+    unsigned long lastPush;
+    bool dirty;
+    bool pending;
+    unsigned long framesPushed;
+    unsigned long framesSkipped;
+    unsigned long pushMicros;
+    unsigned long maxPushMicros;
+
+    void Push();
+};
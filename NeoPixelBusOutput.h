@@ -0,0 +1,38 @@
+#pragma once
+
+#include <NeoPixelBus.h>
+#include "PixelOutput.h"
+
+// Drives the strip through NeoPixelBus, so a frame goes out by I2S DMA or
+// through the UART FIFO instead of being bit-banged with interrupts off.
+// The method fixes the data pin: NeoEsp8266Dma800KbpsMethod sends on GPIO3
+// (RX, so Serial can only transmit), the UART1 methods on GPIO2 (TX1).
+template <typename Method>
+class NeoPixelBusOutput : public PixelOutput
+{
+public:
+    NeoPixelBusOutput(NeoPixelBus<NeoGrbFeature, Method> &strip) : strip(strip), brightness(255) {}
+
+    // DMA takes over the RX pin, call after Serial.begin()
+    void Begin(uint8_t brightness)
+    {
+        this->brightness = brightness;
+        strip.Begin();
+        strip.ClearTo(RgbColor(0));
+        strip.Show();
+    }
+
+    uint16_t Count() const override { return strip.PixelCount(); }
+    void SetPixel(uint16_t index, uint32_t color) override
+    {
+        strip.SetPixelColor(index, RgbColor(Scale(color >> 16), Scale(color >> 8), Scale(color)));
+    }
+    void Show() override { strip.Show(); }
+
+private:
+    NeoPixelBus<NeoGrbFeature, Method> &strip;
+    uint8_t brightness;
+
+    // same scaling as Adafruit_NeoPixel::setBrightness()
+    uint8_t Scale(uint32_t channel) const { return ((channel & 0xFF) * (brightness + 1)) >> 8; }
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Adafruit_NeoPixel.h>
+#include "PixelOutput.h"
+
+class NeoPixelOutput : public PixelOutput
+{
+public:
+    NeoPixelOutput(Adafruit_NeoPixel &pixels) : pixels(pixels) {}
+
+    void Begin(uint8_t brightness)
+    {
+        pixels.begin();
+        pixels.clear();
+        pixels.setBrightness(brightness);
+        pixels.show();
+    }
+
+    uint16_t Count() const override { return pixels.numPixels(); }
+    void SetPixel(uint16_t index, uint32_t color) override { pixels.setPixelColor(index, color); }
+    void Show() override { pixels.show(); }
+
+private:
+    Adafruit_NeoPixel &pixels;
+};
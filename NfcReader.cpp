@@ -0,0 +1,215 @@
+#include "NfcReader.h"
+
+// FNV-1a
+static uint32_t Checksum(const uint8_t *data, size_t size)
+{
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+NfcReader::NfcReader(MFRC522 &mfrc522) : mfrc522(mfrc522)
+{
+    length = 0;
+    messageOffset = 0;
+    messageLength = 0;
+    transactions = 0;
+    totalTransactions = 0;
+    fastRead = true;
+    failed = false;
+}
+
+NfcResult NfcReader::Read()
+{
+    length = 0;
+    messageOffset = 0;
+    messageLength = 0;
+    totalTransactions += transactions;
+    transactions = 0;
+    fastRead = true;
+    failed = false;
+
+    // walk the TLV blocks until the NDEF message, lock and memory control come first on some tags
+    size_t offset = 0;
+    while (Fetch(offset + 1))
+    {
+        uint8_t type = buffer[offset];
+        if (type == TLV_NULL)
+        {
+            offset++;
+            continue;
+        }
+        if (type == TLV_TERMINATOR)
+        {
+            return NfcNoMessage;
+        }
+        if (!Fetch(offset + 2))
+        {
+            break;
+        }
+
+        size_t valueOffset = offset + 2;
+        size_t valueLength = buffer[offset + 1];
+        if (valueLength == 0xFF)
+        {
+            // three byte length format
+            if (!Fetch(offset + 4))
+            {
+                break;
+            }
+            valueOffset = offset + 4;
+            valueLength = (buffer[offset + 2] << 8) | buffer[offset + 3];
+        }
+
+        if (type == TLV_NDEF)
+        {
+            size_t end = valueOffset + valueLength;
+            if (end > NFC_BUFFER_SIZE)
+            {
+                Serial.println("NDEF message truncated");
+                end = NFC_BUFFER_SIZE;
+            }
+            if (!Fetch(end))
+            {
+                break;
+            }
+            messageOffset = valueOffset;
+            messageLength = end - valueOffset;
+            return NfcOk;
+        }
+        offset = valueOffset + valueLength;
+    }
+    // Fetch() also gives up at the end of the buffer, that is a tag without a message
+    return failed ? NfcReadError : NfcNoMessage;
+}
+
+uint8_t NfcReader::GetCheckPage() const
+{
+    size_t lastPage = (GetLength() - 1) / NFC_PAGE_SIZE;
+    size_t firstPage = lastPage + 1 >= NFC_READ_PAGES ? lastPage + 1 - NFC_READ_PAGES : 0;
+    return NFC_FIRST_DATA_PAGE + firstPage;
+}
+
+uint32_t NfcReader::GetCheckSum() const
+{
+    return Checksum(buffer + (GetCheckPage() - NFC_FIRST_DATA_PAGE) * NFC_PAGE_SIZE, NFC_READ_PAGES * NFC_PAGE_SIZE);
+}
+
+// One MIFARE_Read of the block a cached tag was last seen with
+bool NfcReader::ReadCheckSum(uint8_t page, uint32_t &checksum)
+{
+    totalTransactions += transactions;
+    transactions = 0;
+    byte size = NFC_READ_PAGES * NFC_PAGE_SIZE + 2;
+    MFRC522::StatusCode status = mfrc522.MIFARE_Read(page, scratch, &size);
+    transactions++;
+    if (status != MFRC522::STATUS_OK)
+    {
+        return false;
+    }
+    checksum = Checksum(scratch, NFC_READ_PAGES * NFC_PAGE_SIZE);
+    return true;
+}
+
+// Makes sure the first needed bytes of the TLV area are in the buffer
+bool NfcReader::Fetch(size_t needed)
+{
+    if (needed > NFC_BUFFER_SIZE)
+    {
+        return false;
+    }
+    while (length < needed)
+    {
+        uint8_t page = NFC_FIRST_DATA_PAGE + length / NFC_PAGE_SIZE;
+
+        // the header read works on every type 2 tag, so it does not risk a NAK
+        if (length > 0 && fastRead)
+        {
+            size_t pages = (needed - length + NFC_PAGE_SIZE - 1) / NFC_PAGE_SIZE;
+            // fewer pages cost the same exchange, a TLV walk would go a page at a time
+            if (pages < NFC_READ_PAGES)
+            {
+                pages = NFC_READ_PAGES;
+            }
+            if (pages > NFC_FAST_READ_PAGES)
+            {
+                pages = NFC_FAST_READ_PAGES;
+            }
+            if (FastRead(page, pages))
+            {
+                continue;
+            }
+            fastRead = false;
+            Reselect();
+        }
+        if (!MifareRead(page))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NfcReader::FastRead(uint8_t page, uint8_t pages)
+{
+    uint8_t command[5] = {NTAG_CMD_FAST_READ, page, (uint8_t)(page + pages - 1)};
+    if (mfrc522.PCD_CalculateCRC(command, 3, &command[3]) != MFRC522::STATUS_OK)
+    {
+        return false;
+    }
+
+    byte size = pages * NFC_PAGE_SIZE + 2;
+    MFRC522::StatusCode status = mfrc522.PCD_TransceiveData(command, sizeof(command), scratch, &size, nullptr, 0, true);
+    transactions++;
+    if (status != MFRC522::STATUS_OK || size != pages * NFC_PAGE_SIZE + 2)
+    {
+        return false;
+    }
+
+    size_t count = pages * NFC_PAGE_SIZE;
+    if (count > NFC_BUFFER_SIZE - length)
+    {
+        count = NFC_BUFFER_SIZE - length;
+    }
+    memcpy(buffer + length, scratch, count);
+    length += count;
+    return true;
+}
+
+bool NfcReader::MifareRead(uint8_t page)
+{
+    byte size = NFC_READ_PAGES * NFC_PAGE_SIZE + 2;
+    MFRC522::StatusCode status = mfrc522.MIFARE_Read(page, scratch, &size);
+    transactions++;
+    if (status != MFRC522::STATUS_OK)
+    {
+        // a NAK comes from a tag that is there, for a page past its memory
+        failed = status != MFRC522::STATUS_MIFARE_NACK;
+        Serial.print("MIFARE_Read() failed: ");
+        Serial.println(mfrc522.GetStatusCodeName(status));
+        return false;
+    }
+
+    size_t count = NFC_READ_PAGES * NFC_PAGE_SIZE;
+    if (count > NFC_BUFFER_SIZE - length)
+    {
+        count = NFC_BUFFER_SIZE - length;
+    }
+    memcpy(buffer + length, scratch, count);
+    length += count;
+    return true;
+}
+
+// A NAK drops the tag back to IDLE, it has to be woken and selected again
+void NfcReader::Reselect()
+{
+    byte atqa[2];
+    byte atqaSize = sizeof(atqa);
+    mfrc522.PICC_WakeupA(atqa, &atqaSize);
+    mfrc522.PICC_Select(&mfrc522.uid);
+    transactions += 2;
+}
+
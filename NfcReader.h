@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Arduino.h>
+#include "MFRC522.h"
+
+// Type 2 tags (NTAG21x, Ultralight) keep their TLV area from page 4 on
+#define NFC_FIRST_DATA_PAGE 4
+// NTAG213 user memory, longer messages are cut off here
+#define NFC_BUFFER_SIZE 144
+#define NFC_PAGE_SIZE 4
+// MIFARE_Read always answers with four pages
+#define NFC_READ_PAGES 4
+// a FAST_READ answer and its CRC have to fit the 64 byte FIFO of the MFRC522
+#define NFC_FAST_READ_PAGES 15
+
+#define NTAG_CMD_FAST_READ 0x3A
+
+#define TLV_NULL 0x00
+#define TLV_NDEF 0x03
+#define TLV_TERMINATOR 0xFE
+
+enum NfcResult : uint8_t
+{
+    NfcOk,
+    // the tag answered but holds no NDEF message
+    NfcNoMessage,
+    // an exchange with the tag failed, it may have been pulled away mid read
+    NfcReadError
+};
+
+// Reads only as much of a tag as its NDEF message needs. The first read
+// brings in the TLV header, the rest of the message follows in as few
+// FAST_READ bursts as the FIFO allows. Tags that NAK FAST_READ are reselected
+// and read with plain MIFARE_Read.
+class NfcReader
+{
+public:
+    NfcReader(MFRC522 &mfrc522);
+
+    NfcResult Read();
+
+    // pages from NFC_FIRST_DATA_PAGE up to the end of the NDEF message
+    const uint8_t *GetData() const { return buffer; }
+    size_t GetLength() const { return messageOffset + messageLength; }
+    const uint8_t *GetMessage() const { return buffer + messageOffset; }
+    size_t GetMessageLength() const { return messageLength; }
+
+    // The block that ends the message is what a rewrite is most likely to
+    // change, the id of a link sits at its end while the first page only
+    // holds TLV and record headers.
+    uint8_t GetCheckPage() const;
+    uint32_t GetCheckSum() const;
+    bool ReadCheckSum(uint8_t page, uint32_t &checksum);
+
+    // reader to tag exchanges spent on the last tag
+    uint8_t GetTransactions() const { return transactions; }
+    unsigned long GetTotalTransactions() const { return totalTransactions + transactions; }
+
+private:
+    MFRC522 &mfrc522;
+    uint8_t buffer[NFC_BUFFER_SIZE];
+    uint8_t scratch[NFC_FAST_READ_PAGES * NFC_PAGE_SIZE + 2];
+    size_t length;
+    size_t messageOffset;
+    size_t messageLength;
+    uint8_t transactions;
+    unsigned long totalTransactions;
+    bool fastRead;
+    bool failed;
+
+    bool Fetch(size_t needed);
+    bool FastRead(uint8_t page, uint8_t pages);
+    bool MifareRead(uint8_t page);
+    void Reselect();
+};
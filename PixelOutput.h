@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+
+// What the LED effects draw on. Kept free of any driver headers so the
+// effects build without the hardware, the strip itself is NeoPixelOutput.
+class PixelOutput
+{
+public:
+    virtual uint16_t Count() const = 0;
+    virtual void SetPixel(uint16_t index, uint32_t color) = 0;
+    virtual void Show() = 0;
+
+    // Same packing as Adafruit_NeoPixel::Color()
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b)
+    {
+        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+};
@@ -0,0 +1,134 @@
+#include "PlaybackPoller.h"
+
+PlaybackPoller::PlaybackPoller(SpotifyClient &spotify, Clock &clock) : spotify(spotify), clock(clock)
+{
+    pending = false;
+    lastPoll = 0;
+    // the first poll goes out as soon as there is a token
+    interval = 0;
+    event = PlaybackNone;
+    active = false;
+    playing = false;
+    trackId[0] = '\0';
+    polls = 0;
+    notModified = 0;
+    errors = 0;
+}
+
+PlaybackEvent PlaybackPoller::Update()
+{
+    if (!pending && spotify.HasToken() && spotify.Idle() && Due())
+    {
+        pending = true;
+        lastPoll = clock.Millis();
+        polls++;
+        spotify.GetPlayerAsync([this](int httpCode)
+                               { Finished(httpCode); });
+    }
+
+    PlaybackEvent found = event;
+    event = PlaybackNone;
+    return found;
+}
+
+void PlaybackPoller::Poke()
+{
+    // Spotify takes a moment to report a change made through the API
+    lastPoll = clock.Millis();
+    interval = PLAYER_POLL_FAST;
+}
+
+unsigned long PlaybackPoller::GetProgress()
+{
+    const PlaybackState &state = spotify.GetPlayback();
+    if (!state.playing)
+    {
+        return state.progressMs;
+    }
+    unsigned long progress = state.progressMs + (clock.Millis() - state.fetchedAt);
+    return progress < state.durationMs ? progress : state.durationMs;
+}
+
+bool PlaybackPoller::Due()
+{
+    unsigned long sinceLast = clock.Millis() - lastPoll;
+    if (sinceLast >= interval)
+    {
+        return true;
+    }
+
+    // the track should be over by now, see what came next
+    const PlaybackState &state = spotify.GetPlayback();
+    if (playing && sinceLast >= PLAYER_POLL_FAST && state.durationMs > state.progressMs)
+    {
+        return clock.Millis() - state.fetchedAt >= state.durationMs - state.progressMs + PLAYER_TRACK_END_MARGIN;
+    }
+    return false;
+}
+
+void PlaybackPoller::Finished(int httpCode)
+{
+    pending = false;
+
+    if (httpCode == 304)
+    {
+        notModified++;
+        BackOff(playing ? PLAYER_POLL_PLAYING : PLAYER_POLL_IDLE);
+        return;
+    }
+    if (httpCode != 200 && httpCode != 204)
+    {
+        errors++;
+        // rate limited, stay away for as long as we ever do
+        if (httpCode == 429)
+        {
+            interval = PLAYER_POLL_IDLE;
+        }
+        BackOff(PLAYER_POLL_IDLE);
+        return;
+    }
+
+    const PlaybackState &state = spotify.GetPlayback();
+    PlaybackEvent found = PlaybackNone;
+    if (!state.active)
+    {
+        if (active)
+        {
+            found = PlaybackStopped;
+        }
+    }
+    else if (!active || strcmp(trackId, state.trackId) != 0)
+    {
+        found = PlaybackTrackChanged;
+    }
+    else if (state.playing != playing)
+    {
+        found = state.playing ? PlaybackResumed : PlaybackPaused;
+    }
+
+    active = state.active;
+    playing = state.playing;
+    memcpy(trackId, state.trackId, sizeof(trackId));
+
+    if (found == PlaybackNone)
+    {
+        BackOff(playing ? PLAYER_POLL_PLAYING : PLAYER_POLL_IDLE);
+        return;
+    }
+    event = found;
+    interval = PLAYER_POLL_FAST;
+}
+
+// Every answer without news doubles the wait, up to ceiling
+void PlaybackPoller::BackOff(unsigned long ceiling)
+{
+    interval *= 2;
+    if (interval < PLAYER_POLL_FAST)
+    {
+        interval = PLAYER_POLL_FAST;
+    }
+    if (interval > ceiling)
+    {
+        interval = ceiling;
+    }
+}
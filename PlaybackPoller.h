@@ -0,0 +1,64 @@
+#pragma once
+
+#include "SpotifyClient.h"
+#include "Clock.h"
+
+// Poll interval right after a tap or a change, doubled on every answer that
+// shows nothing new up to the ceiling for the current state
+#define PLAYER_POLL_FAST 2000
+#define PLAYER_POLL_PLAYING 30000
+#define PLAYER_POLL_IDLE 120000
+// Look again this long after the current track should have ended
+#define PLAYER_TRACK_END_MARGIN 1500
+
+enum PlaybackEvent : uint8_t
+{
+    PlaybackNone,
+    PlaybackTrackChanged,
+    PlaybackResumed,
+    PlaybackPaused,
+    PlaybackStopped
+};
+
+// Keeps SpotifyClient's view of the player fresh in the background. Polls
+// only go out while the request queue is empty so they never hold up a tap,
+// and at most one is in flight. A playing track gets an extra poll when it
+// should have ended, so track changes show up quickly without polling fast.
+class PlaybackPoller
+{
+public:
+    PlaybackPoller(SpotifyClient &spotify, Clock &clock = systemClock);
+
+    // Called from the scheduler, queues a poll when one is due and reports
+    // what the last finished poll found
+    PlaybackEvent Update();
+    // Something was just changed from here, look again soon
+    void Poke();
+
+    // progress of the current track extrapolated from the last answer
+    unsigned long GetProgress();
+    unsigned long GetInterval() const { return interval; }
+    unsigned long GetPolls() const { return polls; }
+    unsigned long GetNotModified() const { return notModified; }
+    unsigned long GetErrors() const { return errors; }
+
+private:
+    SpotifyClient &spotify;
+    Clock &clock;
+    bool pending;
+    unsigned long lastPoll;
+    unsigned long interval;
+    PlaybackEvent event;
+
+    bool active;
+    bool playing;
+    char trackId[TRACK_ID_SIZE];
+
+    unsigned long polls;
+    unsigned long notModified;
+    unsigned long errors;
+
+    bool Due();
+    void Finished(int httpCode);
+    void BackOff(unsigned long ceiling);
+};
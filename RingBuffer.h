@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// Single producer, single consumer ring buffer for handing data from a timer
+// callback to loop() without masking interrupts. Only the producer writes
+// head and only the consumer writes tail; both run free and wrap at 2^16, so
+// the difference is the fill level and all Capacity slots are usable.
+template <typename T, uint16_t Capacity>
+class RingBuffer
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static_assert(Capacity <= 32768, "Capacity must fit the 16 bit indices");
+
+public:
+    RingBuffer() : head(0), tail(0), overruns(0) {}
+
+    // Producer side. A full buffer keeps what it has and counts the loss.
+    inline __attribute__((always_inline)) bool Push(const T &value)
+    {
+        uint16_t index = head;
+        if ((uint16_t)(index - tail) == Capacity)
+        {
+            overruns = overruns + 1;
+            return false;
+        }
+        items[index & (Capacity - 1)] = value;
+        // the slot has to be written before the consumer can see it
+        __asm__ __volatile__("" ::: "memory");
+        head = index + 1;
+        return true;
+    }
+
+    // Consumer side
+    uint16_t Available() const { return (uint16_t)(head - tail); }
+
+    // copies up to count items out in at most two blocks, returns how many
+    uint16_t Read(T *out, uint16_t count)
+    {
+        uint16_t index = tail;
+        uint16_t available = (uint16_t)(head - index);
+        if (count > available)
+        {
+            count = available;
+        }
+        uint16_t start = index & (Capacity - 1);
+        uint16_t first = Capacity - start < count ? Capacity - start : count;
+        memcpy(out, &items[start], first * sizeof(T));
+        memcpy(out + first, &items[0], (count - first) * sizeof(T));
+        // the copy has to be done before the producer may overwrite the slots
+        __asm__ __volatile__("" ::: "memory");
+        tail = index + count;
+        return count;
+    }
+
+    uint16_t Skip(uint16_t count)
+    {
+        uint16_t available = Available();
+        if (count > available)
+        {
+            count = available;
+        }
+        tail = tail + count;
+        return count;
+    }
+
+    uint32_t GetOverruns() const { return overruns; }
+
+private:
+    T items[Capacity];
+    volatile uint16_t head;
+    volatile uint16_t tail;
+    volatile uint32_t overruns;
+};
@@ -0,0 +1,148 @@
+#include "Scheduler.h"
+
+Scheduler::Scheduler(Clock &clock) : clock(clock)
+{
+    memset(tasks, 0, sizeof(tasks));
+}
+
+TaskId Scheduler::Every(const char *name, unsigned long period, TaskFunction function, unsigned long budgetMicros)
+{
+    // first run one period from now
+    return Add(name, period, period, function, budgetMicros, false);
+}
+
+TaskId Scheduler::After(const char *name, unsigned long delay, TaskFunction function, unsigned long budgetMicros)
+{
+    return Add(name, 0, delay, function, budgetMicros, true);
+}
+
+TaskId Scheduler::Add(const char *name, unsigned long period, unsigned long delay, TaskFunction function, unsigned long budgetMicros, bool oneShot)
+{
+    for (TaskId id = 0; id < SCHEDULER_MAX_TASKS; id++)
+    {
+        Task &task = tasks[id];
+        if (task.active)
+        {
+            continue;
+        }
+        memset(&task, 0, sizeof(Task));
+        task.name = name;
+        task.function = function;
+        task.period = period;
+        task.due = clock.Millis() + delay;
+        task.budgetMicros = budgetMicros;
+        task.oneShot = oneShot;
+        task.active = true;
+        return id;
+    }
+    Serial.print("No room to schedule ");
+    Serial.println(name);
+    return -1;
+}
+
+void Scheduler::Cancel(TaskId id)
+{
+    if (id >= 0 && id < SCHEDULER_MAX_TASKS)
+    {
+        tasks[id].active = false;
+    }
+}
+
+void Scheduler::Run()
+{
+    for (Task &task : tasks)
+    {
+        // signed difference keeps working across the millis() wrap
+        unsigned long now = clock.Millis();
+        if (task.active && (long)(now - task.due) >= 0)
+        {
+            RunTask(task, now);
+        }
+    }
+}
+
+void Scheduler::RunTask(Task &task, unsigned long now)
+{
+    unsigned long lateness = now - task.due;
+    if (task.oneShot)
+    {
+        // a one-shot may schedule itself again from inside the call
+        task.active = false;
+    }
+    else if (task.period > 0 && lateness < task.period)
+    {
+        // stay in phase with the original start
+        task.due += task.period;
+    }
+    else
+    {
+        task.due = now + task.period;
+    }
+
+    unsigned long start = micros();
+    task.function();
+    unsigned long elapsed = micros() - start;
+
+    TaskStats &stats = task.stats;
+    stats.runs++;
+    stats.totalMicros += elapsed;
+    if (elapsed > stats.maxMicros)
+    {
+        stats.maxMicros = elapsed;
+    }
+    if (task.budgetMicros > 0 && elapsed > task.budgetMicros)
+    {
+        stats.overruns++;
+    }
+    if (task.period > 0)
+    {
+        stats.totalLateness += lateness;
+        if (lateness > stats.maxLateness)
+        {
+            stats.maxLateness = lateness;
+        }
+    }
+}
+
+const Task *Scheduler::GetTask(TaskId id) const
+{
+    if (id < 0 || id >= SCHEDULER_MAX_TASKS)
+    {
+        return nullptr;
+    }
+    return &tasks[id];
+}
+
+void Scheduler::PrintStats(Print &out)
+{
+    for (const Task &task : tasks)
+    {
+        if (!task.active || task.stats.runs == 0)
+        {
+            continue;
+        }
+        const TaskStats &stats = task.stats;
+        out.print(task.name);
+        out.print(": runs ");
+        out.print(stats.runs);
+        out.print(", avg ");
+        out.print(stats.totalMicros / stats.runs);
+        out.print(" us, max ");
+        out.print(stats.maxMicros);
+        out.print(" us, overruns ");
+        out.print(stats.overruns);
+        out.print(", late avg ");
+        out.print(stats.totalLateness / stats.runs);
+        out.print(" ms, max ");
+        out.print(stats.maxLateness);
+        out.println(" ms");
+    }
+}
+
+void Scheduler::ResetStats()
+{
+    for (Task &task : tasks)
+    {
+        memset(&task.stats, 0, sizeof(TaskStats));
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Clock.h"
+
+// the sketch schedules eight, the rest is room for one-shots
+#define SCHEDULER_MAX_TASKS 12
+
+typedef int8_t TaskId;
+typedef void (*TaskFunction)();
+
+struct TaskStats
+{
+    unsigned long runs;
+    unsigned long totalMicros;
+    unsigned long maxMicros;
+    // runs that took longer than the task's budget
+    unsigned long overruns;
+    // how late a run started against its due time, in ms
+    unsigned long maxLateness;
+    unsigned long totalLateness;
+};
+
+struct Task
+{
+    const char *name;
+    TaskFunction function;
+    // 0 runs on every pass
+    unsigned long period;
+    unsigned long due;
+    unsigned long budgetMicros;
+    bool active;
+    bool oneShot;
+    TaskStats stats;
+};
+
+// Cooperative scheduler stepped from loop(). Tasks live in a fixed table and
+// run to completion, so a task that blocks holds up all the others; the
+// lateness statistics show who is being held up, the runtime ones who does
+// the holding.
+class Scheduler
+{
+public:
+    Scheduler(Clock &clock = systemClock);
+
+    // -1 when the table is full
+    TaskId Every(const char *name, unsigned long period, TaskFunction function, unsigned long budgetMicros = 0);
+    TaskId After(const char *name, unsigned long delay, TaskFunction function, unsigned long budgetMicros = 0);
+    void Cancel(TaskId id);
+
+    void Run();
+
+    const Task *GetTask(TaskId id) const;
+    void PrintStats(Print &out);
+    void ResetStats();
+
+private:
+    Clock &clock;
+    Task tasks[SCHEDULER_MAX_TASKS];
+
+    TaskId Add(const char *name, unsigned long period, unsigned long delay, TaskFunction function, unsigned long budgetMicros, bool oneShot);
+    void RunTask(Task &task, unsigned long now);
+};
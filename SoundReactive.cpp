@@ -0,0 +1,20 @@
+#include "SoundReactive.h"
+
+SoundReactive::SoundReactive()
+{
+    for (int i = 0; i < SOUND_BANDS; i++)
+    {
+        bands[i] = 0;
+    }
+    beatLevel = 0;
+}
+
+void SoundReactive::Bands(const uint8_t *levels)
+{
+    for (int i = 0; i < SOUND_BANDS; i++)
+    {
+        bands[i] = levels[i];
+    }
+    // halves every frame, gone in about a third of a second
+    beatLevel >>= 1;
+}
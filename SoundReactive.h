@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include "ColorTable.h"
+#include "StripGeometry.h"
+
+#define SOUND_BANDS 8
+
+// Which band each of a strip's positions shows, lowest band first
+template <uint16_t Positions, uint16_t Bands>
+struct PositionBands
+{
+    uint8_t band[Positions];
+
+    constexpr PositionBands() : band()
+    {
+        for (uint16_t position = 0; position < Positions; position++)
+        {
+            band[position] = position * Bands / Positions;
+        }
+    }
+};
+
+// Bass meter display: the bands below 100 Hz that Spectrum gets out of the
+// 200 Hz sampling are spread evenly over the layout's positions. A beat lifts the whole strip, the lift dies away over the next
+// frames. Render() is built for each geometry, the band of every position is
+// worked out by the compiler.
+class SoundReactive
+{
+public:
+    SoundReactive();
+
+    // levels holds SOUND_BANDS values
+    void Bands(const uint8_t *levels);
+    void Beat() { beatLevel = 255; }
+
+    template <typename Geometry, typename Output>
+    void Render(StripLayout<Geometry, Output> &layout)
+    {
+        static constexpr PositionBands<Geometry::positions, SOUND_BANDS> bandOf{};
+        uint8_t lift = beatLevel >> 1;
+        for (uint16_t position = 0; position < Geometry::positions; position++)
+        {
+            int level = bands[bandOf.band[position]] + lift;
+            layout.SetPixel(position, AmplitudeColor(level > 255 ? 255 : level));
+        }
+        layout.Show();
+    }
+
+private:
+    uint8_t bands[SOUND_BANDS];
+    uint8_t beatLevel;
+};
@@ -0,0 +1,124 @@
+#include <math.h>
+#include "Spectrum.h"
+
+// lowest bin of each band, bin 0 is DC and left out; at 200 Hz a bin is 6.25 Hz wide
+static const uint8_t bandEdges[SPECTRUM_BANDS + 1] = {1, 2, 3, 4, 5, 7, 9, 12, FFT_SIZE / 2};
+
+// keeps a quiet room from being stretched to full brightness
+#define SPECTRUM_PEAK_FLOOR 64
+
+Spectrum::Spectrum()
+{
+    for (int i = 0; i < FFT_SIZE; i++)
+    {
+        sine[i] = (int16_t)(32767 * sin(2 * M_PI * i / FFT_SIZE));
+        window[i] = (int16_t)(32767 * 0.5 * (1 - cos(2 * M_PI * i / FFT_SIZE)));
+    }
+    peak = SPECTRUM_PEAK_FLOOR;
+}
+
+void Spectrum::Analyze(const int16_t *samples, uint8_t *levels)
+{
+    // the microphone sits on a DC offset, take the frame's mean out first
+    int32_t sum = 0;
+    for (int i = 0; i < FFT_SIZE; i++)
+    {
+        sum += samples[i];
+    }
+    int16_t mean = sum / FFT_SIZE;
+    for (int i = 0; i < FFT_SIZE; i++)
+    {
+        // 10 bit readings shifted up to use the int16 range
+        int32_t centered = (int32_t)(samples[i] - mean) * 32;
+        re[i] = (centered * window[i]) >> 15;
+        im[i] = 0;
+    }
+
+    Transform();
+
+    for (int i = 0; i < FFT_SIZE / 2; i++)
+    {
+        // alpha max plus beta min, within 4% of the true magnitude
+        uint16_t a = re[i] < 0 ? -re[i] : re[i];
+        uint16_t b = im[i] < 0 ? -im[i] : im[i];
+        magnitudes[i] = a > b ? a + (b >> 2) + (b >> 3) : b + (a >> 2) + (a >> 3);
+    }
+
+    uint16_t loudest = 0;
+    uint16_t bands[SPECTRUM_BANDS];
+    for (int band = 0; band < SPECTRUM_BANDS; band++)
+    {
+        bands[band] = 0;
+        for (int bin = bandEdges[band]; bin < bandEdges[band + 1]; bin++)
+        {
+            if (magnitudes[bin] > bands[band])
+            {
+                bands[band] = magnitudes[bin];
+            }
+        }
+        if (bands[band] > loudest)
+        {
+            loudest = bands[band];
+        }
+    }
+
+    // fast attack, slow release
+    peak -= peak >> 5;
+    if (loudest > peak)
+    {
+        peak = loudest;
+    }
+    if (peak < SPECTRUM_PEAK_FLOOR)
+    {
+        peak = SPECTRUM_PEAK_FLOOR;
+    }
+    for (int band = 0; band < SPECTRUM_BANDS; band++)
+    {
+        uint32_t level = (uint32_t)bands[band] * 255 / peak;
+        levels[band] = level > 255 ? 255 : level;
+    }
+}
+
+// In place radix-2 decimation in time
+void Spectrum::Transform()
+{
+    for (int i = 1, j = 0; i < FFT_SIZE; i++)
+    {
+        int bit = FFT_SIZE >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            int16_t swap = re[i];
+            re[i] = re[j];
+            re[j] = swap;
+            swap = im[i];
+            im[i] = im[j];
+            im[j] = swap;
+        }
+    }
+
+    for (int length = 2; length <= FFT_SIZE; length <<= 1)
+    {
+        int half = length >> 1;
+        int step = FFT_SIZE / length;
+        for (int k = 0; k < half; k++)
+        {
+            int32_t wr = sine[(k * step + FFT_SIZE / 4) % FFT_SIZE];
+            int32_t wi = -sine[k * step];
+            for (int i = k; i < FFT_SIZE; i += length)
+            {
+                int j = i + half;
+                int32_t tr = (wr * re[j] - wi * im[j]) >> 15;
+                int32_t ti = (wr * im[j] + wi * re[j]) >> 15;
+                re[j] = (re[i] - tr) >> 1;
+                im[j] = (im[i] - ti) >> 1;
+                re[i] = (re[i] + tr) >> 1;
+                im[i] = (im[i] + ti) >> 1;
+            }
+        }
+    }
+}
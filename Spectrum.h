@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FFT_SIZE 32
+#define FFT_LOG2_SIZE 5
+// new samples per frame, the frames overlap so the strip and the beat
+// detector get 25 frames a second out of 200 Hz sampling
+#define FFT_HOP 8
+#define SPECTRUM_BANDS 8
+
+// 32 point fixed-point FFT over a Hann windowed frame of 10 bit ADC samples,
+// folded into SPECTRUM_BANDS roughly logarithmic bands. Everything is int16
+// Q15 with a halving per butterfly stage, so no stage can overflow.
+//
+// At the 200 Hz AUDIO_SAMPLE_RATE a bin is 6.25 Hz wide and the bands run
+// from 6 to 100 Hz, so this is a bass meter: kick, bass line and beat, no
+// vocals, no hi-hats. The FFT itself is rate agnostic, a faster sampler
+// would only need new band edges.
+class Spectrum
+{
+public:
+    Spectrum();
+
+    // samples holds FFT_SIZE raw readings, levels gets SPECTRUM_BANDS values 0-255
+    void Analyze(const int16_t *samples, uint8_t *levels);
+
+    // magnitude of one bin of the last frame, bins 0 to FFT_SIZE / 2 - 1
+    uint16_t GetBin(uint8_t bin) const { return magnitudes[bin]; }
+    const uint16_t *GetMagnitudes() const { return magnitudes; }
+
+private:
+    int16_t sine[FFT_SIZE];
+    int16_t window[FFT_SIZE];
+    int16_t re[FFT_SIZE];
+    int16_t im[FFT_SIZE];
+    uint16_t magnitudes[FFT_SIZE / 2];
+    // slowly decaying loudest band, levels are relative to it
+    uint16_t peak;
+
+    void Transform();
+};
@@ -1,273 +1,620 @@
-#include <ESP8266HTTPClient.h>
 #include <base64.h>
 #include <Arduino.h>
 #include "SpotifyClient.h"
 
-SpotifyClient::SpotifyClient(String clientId, String clientSecret, String deviceName, String refreshToken)
+// FNV-1a, only used to notice that the compiled in refresh token changed
+static uint32_t Fingerprint(const String &text)
 {
-    this->clientId = clientId;
-    this->clientSecret = clientSecret;
-    this->refreshToken = refreshToken;
-    this->deviceName = deviceName;
+    uint32_t hash = 2166136261UL;
+    for (unsigned int i = 0; i < text.length(); i++)
+    {
+        hash = (hash ^ (uint8_t)text.charAt(i)) * 16777619UL;
+    }
+    return hash;
+}
 
-    wifiClient.setInsecure(); //the magic line, use with caution
+static void CopyField(char *field, size_t size, const String &value)
+{
+    strncpy(field, value.c_str(), size - 1);
+    field[size - 1] = '\0';
 }
 
-void SpotifyClient::FetchToken()
+SpotifyClient::SpotifyClient(const String &clientId, const String &clientSecret, const String &deviceName, const String &refreshToken, Clock &clock)
+    : request(connections), clock(clock), clientId(clientId), clientSecret(clientSecret), refreshToken(refreshToken), deviceName(deviceName),
+      tokenParser(tokenListener), deviceListener(this->deviceName), deviceParser(deviceListener), playerParser(playerListener)
 {
-    HTTPClient http;
-    String body = "grant_type=refresh_token&refresh_token=" + refreshToken;
-    String authorizationRaw = clientId + ":" + clientSecret;
-    String authorization = base64::encode(authorizationRaw);
-    http.begin(wifiClient, "https://accounts.spotify.com/api/token");
-    http.addHeader("Content-Type", "application/x-www-form-urlencoded");
-    http.addHeader("Authorization", "Basic " + authorization);
+    basicCredentials = base64::encode(clientId + ":" + clientSecret);
+    store = nullptr;
+    seed = Fingerprint(refreshToken);
+    tokenFetchedAt = 0;
+    tokenLifetime = 0;
+    lastRefreshAttempt = 0;
+    shuffleOn = false;
+    shuffleConfirmedAt = 0;
+    tapInProgress = false;
+    tapId = 0;
+    tapRoundTrips = 0;
+    memset(&playback, 0, sizeof(PlaybackState));
 
-    int httpCode = http.POST(body);
-    if (httpCode > 0)
+    queueHead = 0;
+    queueCount = 0;
+    nextHandle = 1;
+    completedNext = 0;
+    for (int i = 0; i < COMPLETED_HISTORY_SIZE; i++)
     {
-        String returnedPayload = http.getString();
-        if (httpCode == 200)
-        {
-            accessToken = ParseJson("access_token", returnedPayload);
-            Serial.println("Got new access token");
-            Serial.print("Token:");
-            Serial.println(accessToken);
-        }
-        else
-        {
-            Serial.println("Failed to get new access token");
-            Serial.println(httpCode);
-            Serial.println(returnedPayload);
-        }
+        completed[i].handle = 0;
+        completed[i].httpCode = 0;
     }
-    else
+}
+
+// Called from the sketch loop() on every pass. Advances the request in
+// flight and keeps the token fresh so a tap never waits on a refresh.
+void SpotifyClient::Loop()
+{
+    if (queueCount == 0 && TokenExpiring() && clock.Millis() - lastRefreshAttempt >= TOKEN_RETRY_INTERVAL)
     {
-        Serial.println("Failed to connect to https://accounts.spotify.com/api/token");
-        Serial.println(httpCode);
-        String returnedPayload = http.getString();
-        Serial.println(returnedPayload);
+        Serial.println("Access token about to expire, refreshing");
+        FetchTokenAsync();
     }
-    http.end();
+    Step();
 }
 
-void SpotifyClient::GetDevices()
+// Keeps TLS sessions, the device id and tokens in fs so a warm boot can skip
+// straight to playing. Everything restored is used optimistically: a stale
+// device id shows up as a 404 and a stale token as a 401, both recovered by
+// PlaySpotifyUriAsync.
+void SpotifyClient::SetStore(fs::FS *fs)
 {
-    HttpResult result = CallAPI("GET", "https://api.spotify.com/v1/me/player/devices", "");
-    Serial.println(result.payload);
-    deviceId = GetDeviceId(result.payload);
-    Serial.print("Device ID: ");
+    store = fs;
+    connections.SetSessionStore(fs);
+    if (store)
+    {
+        LoadState();
+    }
+}
+
+void SpotifyClient::LoadState()
+{
+    File file = store->open(STATE_FILE, "r");
+    if (!file)
+    {
+        return;
+    }
+
+    StoredState state;
+    bool valid = file.size() == sizeof(StoredState) && file.read((uint8_t *)&state, sizeof(StoredState)) == sizeof(StoredState);
+    file.close();
+    if (!valid || state.magic != STATE_MAGIC || state.seed != seed)
+    {
+        Serial.println("Ignoring stored Spotify state");
+        return;
+    }
+
+    if (state.refreshToken[0] != '\0')
+    {
+        refreshToken = state.refreshToken;
+    }
+    if (deviceName == state.deviceName)
+    {
+        deviceId = state.deviceId;
+    }
+    if (state.accessToken[0] != '\0')
+    {
+        // there is no wall clock at boot to tell how old the token is, use it
+        // straight away but let the first Loop() replace it in the background
+        accessToken = state.accessToken;
+        tokenFetchedAt = clock.Millis();
+        tokenLifetime = TOKEN_REFRESH_MARGIN;
+        lastRefreshAttempt = clock.Millis() - TOKEN_RETRY_INTERVAL;
+    }
+    Serial.print("Restored Spotify state, device ID: ");
     Serial.println(deviceId);
 }
 
-String SpotifyClient::GetDeviceId(String json)
+void SpotifyClient::SaveState()
 {
-    String id = "";
+    if (!store)
+    {
+        return;
+    }
+
+    StoredState state;
+    memset(&state, 0, sizeof(StoredState));
+    state.magic = STATE_MAGIC;
+    state.seed = seed;
+    CopyField(state.deviceName, sizeof(state.deviceName), deviceName);
+    CopyField(state.deviceId, sizeof(state.deviceId), deviceId);
+    CopyField(state.refreshToken, sizeof(state.refreshToken), refreshToken);
+    CopyField(state.accessToken, sizeof(state.accessToken), accessToken);
 
-    // find the position the device name
-    int index = json.indexOf(deviceName);
-    if (index > 0)
+    File file = store->open(STATE_FILE, "w");
+    if (!file)
     {
-        // we found it, so not backup to begining of this object
-        int i = index;
-        for (; i > 0; i--)
-        {
-            if (json.charAt(i) == '{')
-            {
-                break;
-            }
-        }
+        return;
+    }
+    file.write((const uint8_t *)&state, sizeof(StoredState));
+    file.close();
+}
 
-        // now move forward and find "id"
-        for (; i < json.length(); i++)
-        {
-            if (json.charAt(i) == '}')
-            {
-                break;
-            }
-
-            if (i + 3 < json.length() && json.charAt(i) == '"' && json.charAt(i + 1) == 'i' && json.charAt(i + 2) == 'd' && json.charAt(i + 3) == '"')
-            {
-                i += 4;
-                break;
-            }
-        }
+bool SpotifyClient::TokenExpiring()
+{
+    return tokenLifetime == 0 || clock.Millis() - tokenFetchedAt + TOKEN_REFRESH_MARGIN >= tokenLifetime;
+}
+
+bool SpotifyClient::TokenExpired()
+{
+    return tokenLifetime == 0 || clock.Millis() - tokenFetchedAt >= tokenLifetime;
+}
 
-        // move forward to next "
-        for (; i < json.length(); i++)
+RequestStatus SpotifyClient::GetStatus(RequestHandle handle)
+{
+    for (uint8_t i = 0; i < queueCount; i++)
+    {
+        if (queue[(queueHead + i) % REQUEST_QUEUE_SIZE].handle == handle)
         {
-            if (json.charAt(i) == '"')
-            {
-                i++;
-                break;
-            }
+            return RequestPending;
         }
-
-        // now get that device id
-        for (; i < json.length(); i++)
+    }
+    for (int i = 0; i < COMPLETED_HISTORY_SIZE; i++)
+    {
+        if (handle != 0 && completed[i].handle == handle)
         {
-            if (json.charAt(i) != '"')
-            {
-                id += json.charAt(i);
-            }
-            else
-            {
-                break;
-            }
+            return completed[i].httpCode > 0 ? RequestDone : RequestFailed;
         }
     }
-    else
+    return handle == 0 ? RequestFailed : RequestUnknown;
+}
+
+bool SpotifyClient::FetchToken()
+{
+    return Await(FetchTokenAsync()) == 200;
+}
+
+void SpotifyClient::GetDevices()
+{
+    Await(GetDevicesAsync());
+}
+
+int SpotifyClient::Play(const String &context_uri)
+{
+    return Await(PlayAsync(context_uri));
+}
+
+int SpotifyClient::Next()
+{
+    return Await(NextAsync());
+}
+
+int SpotifyClient::Pause()
+{
+    return Await(PauseAsync());
+}
+
+int SpotifyClient::Shuffle()
+{
+    return Await(ShuffleAsync());
+}
+
+void SpotifyClient::PlaySpotifyUri(const String &context_uri)
+{
+    bool finished = false;
+    PlaySpotifyUriAsync(context_uri, [&finished](int httpCode)
+                        { finished = true; });
+    while (!finished)
     {
-        Serial.print(deviceName);
-        Serial.println(" device name not found.");
+        Step();
+        yield();
     }
-    return id;
 }
 
-int SpotifyClient::Play(String context_uri)
+RequestHandle SpotifyClient::FetchTokenAsync(RequestCallback callback)
+{
+    lastRefreshAttempt = clock.Millis();
+    FixedString<REQUEST_BODY_SIZE> body("grant_type=refresh_token&refresh_token=");
+    body.Append(refreshToken.c_str());
+    return CallAPI(TokenRequest, "POST", "/api/token", "", body.c_str(), std::move(callback));
+}
+
+RequestHandle SpotifyClient::GetDevicesAsync(RequestCallback callback)
+{
+    return CallAPI(DevicesRequest, "GET", "/v1/me/player/devices", "", "", std::move(callback));
+}
+
+// Conditional on the ETag of the last full answer, so a player that has not
+// changed costs a bodiless 304
+RequestHandle SpotifyClient::GetPlayerAsync(RequestCallback callback)
+{
+    return CallAPI(PlayerRequest, "GET", PLAYER_PATH, "", "", std::move(callback));
+}
+
+RequestHandle SpotifyClient::PlayAsync(const String &context_uri, RequestCallback callback)
+{
+    return QueuePlay(context_uri.c_str(), std::move(callback));
+}
+
+RequestHandle SpotifyClient::QueuePlay(const char *context_uri, RequestCallback callback)
 {
     Serial.println("SpotifyClient::Play()");
-    String body = "{\"context_uri\":\"" + context_uri + "\",\"offset\":{\"position\":0,\"position_ms\":0}}";
+    FixedString<REQUEST_BODY_SIZE> body("{\"context_uri\":\"");
+    body.Append(context_uri).Append("\",\"offset\":{\"position\":0,\"position_ms\":0}}");
     Serial.print("body");
-    Serial.println(body);
-    String url = "https://api.spotify.com/v1/me/player/play?device_id=" + deviceId;
-
-    HttpResult result = SpotifyClient::CallAPI("PUT", url, body);
-    Serial.println(result.payload);
-    return result.httpCode;
+    Serial.println(body.c_str());
+    return CallAPI(ApiRequest, "PUT", "/v1/me/player/play?device_id=", deviceId.c_str(), body.c_str(), std::move(callback));
 }
 
-int SpotifyClient::Next()
+RequestHandle SpotifyClient::NextAsync(RequestCallback callback)
 {
     Serial.println("SpotifyClient::Next()");
-    HttpResult result = SpotifyClient::CallAPI("POST", "https://api.spotify.com/v1/me/player/next?device_id=" + deviceId, "");
-    Serial.print("Next:");
-    Serial.println(result.payload);
-    return result.httpCode;
+    return CallAPI(ApiRequest, "POST", "/v1/me/player/next?device_id=", deviceId.c_str(), "", std::move(callback));
 }
 
-int SpotifyClient::Shuffle()
+RequestHandle SpotifyClient::PauseAsync(RequestCallback callback)
+{
+    Serial.println("SpotifyClient::Pause()");
+    return CallAPI(ApiRequest, "PUT", "/v1/me/player/pause?device_id=", deviceId.c_str(), "", std::move(callback));
+}
+
+RequestHandle SpotifyClient::ShuffleAsync(RequestCallback callback)
 {
     Serial.println("Shuffle()");
-    HttpResult result = SpotifyClient::CallAPI("PUT", "https://api.spotify.com/v1/me/player/shuffle?state=true&device_id=" + deviceId, "");
-    return result.httpCode;
+    return CallAPI(ShuffleRequest, "PUT", "/v1/me/player/shuffle?state=true&device_id=", deviceId.c_str(), "", std::move(callback));
 }
 
-void SpotifyClient::PlaySpotifyUri(String context_uri)
+// Only the latest tap is followed through, a new one takes over the retry
+// of a tap still in flight. Each tap has an id its requests carry along, what
+// comes back for a replaced one is dropped.
+RequestHandle SpotifyClient::PlaySpotifyUriAsync(const String &context_uri, RequestCallback callback)
 {
-    int code = Play(context_uri);
-    Shuffle();
-    switch (code)
+    uint16_t tap = ++tapId;
+    tapInProgress = true;
+    tapRoundTrips = 0;
+    tapUri.Clear();
+    tapUri.Append(context_uri.c_str());
+    tapCallback = std::move(callback);
+
+    // Loop() normally refreshes ahead of time, only a token that is already dead has to go first
+    if (TokenExpired())
+    {
+        FetchTokenAsync();
+    }
+
+    return QueuePlayAndShuffle([this, tap](int httpCode)
+                               { PlayFinished(tap, httpCode); });
+}
+
+// Shuffle goes out in the same write as play unless we already know it is on
+RequestHandle SpotifyClient::QueuePlayAndShuffle(RequestCallback callback)
+{
+    RequestHandle handle = QueuePlay(tapUri.c_str(), std::move(callback));
+    if (!ShuffleKnownOn())
+    {
+        Serial.println("Shuffle()");
+        CallAPI(ShuffleRequest, "PUT", "/v1/me/player/shuffle?state=true&device_id=", deviceId.c_str(), "", nullptr, true);
+    }
+    return handle;
+}
+
+bool SpotifyClient::ShuffleKnownOn()
+{
+    return shuffleOn && clock.Millis() - shuffleConfirmedAt < SHUFFLE_STATE_TTL;
+}
+
+void SpotifyClient::PlayFinished(uint16_t tap, int httpCode)
+{
+    if (tap != tapId)
+    {
+        return;
+    }
+
+    auto replay = [this, tap](int)
+    {
+        if (tap == tapId)
+        {
+            QueuePlayAndShuffle([this, tap](int httpCode)
+                                { FinishTap(tap, httpCode); });
+        }
+    };
+
+    switch (httpCode)
     {
     case 404:
     {
         // device id changed, get new one
-        GetDevices();
-        Play(context_uri);
-        Shuffle();
-        break;
+        shuffleOn = false;
+        GetDevicesAsync(replay);
+        return;
     }
     case 401:
     {
         // auth token expired, get new one
-        FetchToken();
-        Play(context_uri);
-        Shuffle();
+        FetchTokenAsync(replay);
+        return;
+    }
+    default:
+    {
+        break;
+    }
+    }
+
+    FinishTap(tap, httpCode);
+}
+
+void SpotifyClient::FinishTap(uint16_t tap, int httpCode)
+{
+    if (tap != tapId)
+    {
+        return;
+    }
+
+    tapInProgress = false;
+    Serial.print("Round trips for this tap: ");
+    Serial.println(tapRoundTrips);
+
+    RequestCallback callback = std::move(tapCallback);
+    tapCallback = nullptr;
+    if (callback)
+    {
+        callback(httpCode);
+    }
+}
+
+RequestHandle SpotifyClient::CallAPI(RequestKind kind, const char *method, const char *path, const char *pathSuffix, const char *body, RequestCallback callback, bool pipelined)
+{
+    if (queueCount == REQUEST_QUEUE_SIZE)
+    {
+        Serial.print(path);
+        Serial.println(" dropped, request queue full");
+        if (callback)
+        {
+            callback(HTTP_ERROR_QUEUE_FULL);
+        }
+        return 0;
+    }
+
+    PendingRequest &pending = queue[(queueHead + queueCount) % REQUEST_QUEUE_SIZE];
+    pending.handle = nextHandle++;
+    if (nextHandle == 0)
+    {
+        nextHandle = 1;
+    }
+    pending.kind = kind;
+    // only a request queued right behind another api.spotify.com one can share its write
+    pending.pipelined = pipelined && kind != TokenRequest && queueCount > 0 && queue[(queueHead + queueCount - 1) % REQUEST_QUEUE_SIZE].kind != TokenRequest;
+    pending.method = method;
+    pending.path.Clear();
+    pending.path.Append(path).Append(pathSuffix);
+    pending.body.Clear();
+    pending.body.Append(body);
+    pending.callback = std::move(callback);
+    queueCount++;
+    return pending.handle;
+}
+
+void SpotifyClient::Step()
+{
+    if (!request.Busy())
+    {
+        if (queueCount == 0)
+        {
+            return;
+        }
+        Start(queue[queueHead]);
+    }
+    if (!request.Step())
+    {
+        Complete();
+    }
+}
+
+void SpotifyClient::Start(PendingRequest &pending)
+{
+    if (tapInProgress)
+    {
+        tapRoundTrips++;
+    }
+
+    switch (pending.kind)
+    {
+    case TokenRequest:
+    {
+        tokenListener.Reset();
+        tokenParser.Reset();
+        request.Begin(pending.method, SPOTIFY_ACCOUNTS_HOST, pending.path.c_str(), "Basic", basicCredentials.c_str(), "application/x-www-form-urlencoded", pending.body.c_str(), &tokenParser);
+        break;
+    }
+    case DevicesRequest:
+    {
+        deviceListener.Reset();
+        deviceParser.Reset();
+        request.Begin(pending.method, SPOTIFY_API_HOST, pending.path.c_str(), "Bearer", accessToken.c_str(), "application/json", pending.body.c_str(), &deviceParser);
+        break;
+    }
+    case PlayerRequest:
+    {
+        playerListener.Reset();
+        playerParser.Reset();
+        request.Begin(pending.method, SPOTIFY_API_HOST, pending.path.c_str(), "Bearer", accessToken.c_str(), "application/json", pending.body.c_str(), &playerParser, playerETag.c_str());
         break;
     }
     default:
     {
+        request.Begin(pending.method, SPOTIFY_API_HOST, pending.path.c_str(), "Bearer", accessToken.c_str(), "application/json", pending.body.c_str(), nullptr);
         break;
     }
     }
+
+    if (queueCount > 1)
+    {
+        PendingRequest &next = queue[(queueHead + 1) % REQUEST_QUEUE_SIZE];
+        if (next.pipelined && next.kind != DevicesRequest)
+        {
+            request.Pipeline(next.method, next.path.c_str(), "Bearer", accessToken.c_str(), "application/json", next.body.c_str());
+        }
+    }
 }
 
-HttpResult SpotifyClient::CallAPI(String method, String url, String body)
+void SpotifyClient::Complete()
 {
+    PendingRequest &pending = queue[queueHead];
+    int httpCode = request.GetHttpCode();
+    RequestKind kind = pending.kind;
+    RequestCallback callback = std::move(pending.callback);
 
-    HttpResult result;
-    result.httpCode = 0;
-    Serial.print(url);
+    Serial.print(pending.path.c_str());
     Serial.print(" returned: ");
+    Serial.println(httpCode);
+    if (request.GetPayload()[0] != '\0')
+    {
+        Serial.println(request.GetPayload());
+    }
 
-    HTTPClient http;
+    completed[completedNext].handle = pending.handle;
+    completed[completedNext].httpCode = httpCode;
+    completedNext = (completedNext + 1) % COMPLETED_HISTORY_SIZE;
 
-    http.begin(wifiClient, url);
+    // free the slot before the callback, it may queue follow-up requests
+    pending.callback = nullptr;
+    queueHead = (queueHead + 1) % REQUEST_QUEUE_SIZE;
+    queueCount--;
 
-    String authorization = "Bearer " + accessToken;
+    if (kind == TokenRequest)
+    {
+        ApplyToken(httpCode);
+    }
+    else if (kind == DevicesRequest)
+    {
+        ApplyDevices(httpCode);
+    }
+    else if (kind == PlayerRequest)
+    {
+        ApplyPlayer(httpCode);
+    }
+    else if (kind == ShuffleRequest && httpCode >= 200 && httpCode < 300)
+    {
+        shuffleOn = true;
+        shuffleConfirmedAt = clock.Millis();
+    }
 
-    http.addHeader(F("Content-Type"), "application/json");
-    http.addHeader(F("Authorization"), authorization);
+    // the next request was written together with this one, its response is
+    // already on the way; read it only once this response's headers are used
+    if (request.FollowUpSent() && queueCount > 0)
+    {
+        request.ContinuePipelined(queue[queueHead].method, nullptr);
+    }
 
-    // address bug where Content-Length not added by HTTPClient is content length is zero
-    if (body.length() == 0)
+    if (callback)
     {
-        http.addHeader(F("Content-Length"), String(0));
+        callback(httpCode);
     }
+}
 
-    if (method == "PUT")
+void SpotifyClient::ApplyToken(int httpCode)
+{
+    if (httpCode != 200 || tokenListener.accessToken.length() == 0)
     {
-        result.httpCode = http.PUT(body);
+        Serial.println("Failed to get new access token");
+        return;
     }
-    else if (method == "POST")
+
+    accessToken = tokenListener.accessToken;
+    if (tokenListener.refreshToken.length() > 0)
     {
-        result.httpCode = http.POST(body);
+        // Spotify may rotate the refresh token, the old one stops working
+        refreshToken = tokenListener.refreshToken;
     }
-    else if (method == "GET")
+    tokenFetchedAt = lastRefreshAttempt;
+    // Spotify tokens last an hour, assume that if the field is missing
+    tokenLifetime = (tokenListener.expiresIn > 0 ? tokenListener.expiresIn : 3600) * 1000UL;
+    Serial.println("Got new access token");
+    Serial.print("Token:");
+    Serial.println(accessToken);
+    Serial.print("Expires in: ");
+    Serial.println(tokenListener.expiresIn);
+    SaveState();
+}
+
+void SpotifyClient::ApplyDevices(int httpCode)
+{
+    if (httpCode != 200)
     {
-        result.httpCode = http.GET();
+        return;
     }
 
-    if (result.httpCode > 0)
+    if (deviceListener.found)
     {
-        Serial.println(result.httpCode);
-        if (http.getSize() > 0)
+        if (deviceId != deviceListener.deviceId)
         {
-            result.payload = http.getString();
+            shuffleOn = false;
         }
+        deviceId = deviceListener.deviceId;
+        SaveState();
     }
     else
     {
-        Serial.print("Failed to connect to ");
-        Serial.println(url);
+        deviceId = "";
+        Serial.print(deviceName);
+        Serial.println(" device name not found.");
     }
-    http.end();
-
-    return result;
+    Serial.print("Device ID: ");
+    Serial.println(deviceId);
 }
 
-String SpotifyClient::ParseJson(String key, String json)
+void SpotifyClient::ApplyPlayer(int httpCode)
 {
-    String retVal = "";
-    int index = json.indexOf(key);
+    switch (httpCode)
+    {
+    case 200:
+    {
+        playback.active = true;
+        playback.playing = playerListener.playing;
+        memcpy(playback.trackId, playerListener.trackId, sizeof(playback.trackId));
+        playback.progressMs = playerListener.progressMs;
+        playback.durationMs = playerListener.durationMs;
+        playback.fetchedAt = clock.Millis();
+        playerETag.Clear();
+        playerETag.Append(request.GetETag());
+        if (playerListener.hasShuffle && deviceId == playerListener.deviceId)
+        {
+            // free confirmation, saves the shuffle request on the next tap
+            shuffleOn = playerListener.shuffle;
+            shuffleConfirmedAt = clock.Millis();
+        }
+        else if (playerListener.hasShuffle)
+        {
+            // another device's shuffle state says nothing about ours
+            shuffleOn = false;
+        }
+        break;
+    }
+    case 204:
+    {
+        // nothing playing anywhere
+        memset(&playback, 0, sizeof(PlaybackState));
+        playback.fetchedAt = clock.Millis();
+        playerETag.Clear();
+        break;
+    }
+    default:
+    {
+        // 304 leaves the state as it was, errors are retried by the poller
+        break;
+    }
+    }
+}
 
-    if (index > 0)
+int SpotifyClient::Await(RequestHandle handle)
+{
+    while (GetStatus(handle) == RequestPending)
+    {
+        Step();
+        yield();
+    }
+    for (int i = 0; i < COMPLETED_HISTORY_SIZE; i++)
     {
-        bool copy = false;
-        for (int i = index; i < json.length(); i++)
+        if (handle != 0 && completed[i].handle == handle)
         {
-            //Serial.print( "charAt: " );
-            //Serial.println( json.charAt(i) );
-            if (copy)
-            {
-                if (json.charAt(i) == '"' || json.charAt(i) == ',')
-                {
-                    break;
-                }
-                else
-                {
-                    retVal += json.charAt(i);
-                }
-            }
-            else if (json.charAt(i) == ':')
-            {
-                copy = true;
-                if (json.charAt(i + 1) == '"')
-                {
-                    i++;
-                }
-            }
+            return completed[i].httpCode;
         }
     }
-    return retVal;
+    return HTTP_ERROR_QUEUE_FULL;
 }
@@ -1,34 +1,195 @@
+#pragma once
+
+#include <functional>
 #include <WiFiClientSecure.h>
+#include "ConnectionPool.h"
+#include "HttpRequest.h"
+#include "JsonStreamParser.h"
+#include "SpotifyJson.h"
+#include "Clock.h"
+#include "FixedString.h"
+
+// Refresh the access token this long before Spotify would reject it
+#define TOKEN_REFRESH_MARGIN 300000
+// Wait this long before retrying a failed background refresh
+#define TOKEN_RETRY_INTERVAL 30000
+
+// Trust a shuffle state we saw confirmed for this long before asking again
+#define SHUFFLE_STATE_TTL 600000
+
+#define STATE_FILE "/spotify_state"
+#define STATE_MAGIC 0x53505431
+
+#define REQUEST_QUEUE_SIZE 6
+#define REQUEST_PATH_SIZE 128
+#define REQUEST_BODY_SIZE 256
+#define CONTEXT_URI_SIZE 96
+#define COMPLETED_HISTORY_SIZE 4
+
+// market=from_token drops available_markets, by far the largest part of the item
+#define PLAYER_PATH "/v1/me/player?market=from_token"
+
+typedef uint16_t RequestHandle;
+typedef std::function<void(int httpCode)> RequestCallback;
+
+enum RequestStatus : uint8_t
+{
+    RequestUnknown,
+    RequestPending,
+    RequestDone,
+    RequestFailed
+};
+
+enum RequestKind : uint8_t
+{
+    ApiRequest,
+    TokenRequest,
+    DevicesRequest,
+    ShuffleRequest,
+    PlayerRequest
+};
+
+struct PendingRequest
+{
+    RequestHandle handle;
+    RequestKind kind;
+    bool pipelined;
+    const char *method;
+    FixedString<REQUEST_PATH_SIZE> path;
+    FixedString<REQUEST_BODY_SIZE> body;
+    RequestCallback callback;
+};
 
-struct HttpResult
+// What survives a reboot. seed identifies the refresh token the sketch was
+// built with so a reflashed token wins over a stale cache.
+struct StoredState
 {
+    uint32_t magic;
+    uint32_t seed;
+    char deviceName[64];
+    char deviceId[48];
+    char refreshToken[256];
+    char accessToken[JSON_VALUE_SIZE];
+};
+
+// What the user's player was doing when /v1/me/player last answered,
+// progressMs is as of fetchedAt. active is false while no device is playing
+// or paused.
+struct PlaybackState
+{
+    bool active;
+    bool playing;
+    char trackId[TRACK_ID_SIZE];
+    unsigned long progressMs;
+    unsigned long durationMs;
+    unsigned long fetchedAt;
+};
+
+struct CompletedRequest
+{
+    RequestHandle handle;
     int httpCode;
-    String payload;
 };
 
+// Every call is queued and worked off a little at a time from Loop(), the
+// *Async methods return straight away with a handle and report through the
+// callback. The blocking methods run the same queue until their request is
+// done and are meant for setup().
 class SpotifyClient
 {
 public:
-    SpotifyClient(String clientId, String clientSecret, String deviceName, String refreshToken);
+    SpotifyClient(const String &clientId, const String &clientSecret, const String &deviceName, const String &refreshToken, Clock &clock = systemClock);
 
-    void FetchToken();
-    int Play(String context_uri);
-    void PlaySpotifyUri(String context_uri);
+    void Loop();
+    RequestStatus GetStatus(RequestHandle handle);
+    bool Idle() const { return queueCount == 0; }
+
+    bool FetchToken();
+    int Play(const String &context_uri);
+    void PlaySpotifyUri(const String &context_uri);
     int Shuffle();
     int Next();
+    int Pause();
     void GetDevices();
 
+    RequestHandle FetchTokenAsync(RequestCallback callback = nullptr);
+    RequestHandle PlayAsync(const String &context_uri, RequestCallback callback = nullptr);
+    RequestHandle PlaySpotifyUriAsync(const String &context_uri, RequestCallback callback = nullptr);
+    RequestHandle ShuffleAsync(RequestCallback callback = nullptr);
+    RequestHandle NextAsync(RequestCallback callback = nullptr);
+    RequestHandle PauseAsync(RequestCallback callback = nullptr);
+    RequestHandle GetDevicesAsync(RequestCallback callback = nullptr);
+    RequestHandle GetPlayerAsync(RequestCallback callback = nullptr);
+
+    void SetStore(fs::FS *fs);
+    bool HasToken() const { return accessToken.length() > 0; }
+    bool HasDevice() const { return deviceId.length() > 0; }
+    const PlaybackState &GetPlayback() const { return playback; }
+
+    unsigned long GetConnectionHits() const { return connections.GetHits(); }
+    unsigned long GetConnectionMisses() const { return connections.GetMisses(); }
+    unsigned long GetFullHandshakes() const { return connections.GetFullHandshakes(); }
+    unsigned long GetResumedHandshakes() const { return connections.GetResumedHandshakes(); }
+    uint8_t GetLastTapRoundTrips() const { return tapRoundTrips; }
+
 private:
-    WiFiClientSecure wifiClient;
+    ConnectionPool connections;
+    HttpRequest request;
+    Clock &clock;
     String clientId;
     String clientSecret;
     String redirectUri;
+    String basicCredentials;
     String accessToken;
     String refreshToken;
     String deviceId;
     String deviceName;
 
-    String ParseJson(String key, String json);
-    HttpResult CallAPI(String method, String url, String body);
-    String GetDeviceId(String json);
-};
\ No newline at end of file
+    fs::FS *store;
+    uint32_t seed;
+    unsigned long tokenFetchedAt;
+    unsigned long tokenLifetime;
+    unsigned long lastRefreshAttempt;
+    bool shuffleOn;
+    unsigned long shuffleConfirmedAt;
+    bool tapInProgress;
+    uint16_t tapId;
+    uint8_t tapRoundTrips;
+    FixedString<CONTEXT_URI_SIZE> tapUri;
+    RequestCallback tapCallback;
+    PlaybackState playback;
+    FixedString<HTTP_ETAG_SIZE> playerETag;
+
+    PendingRequest queue[REQUEST_QUEUE_SIZE];
+    uint8_t queueHead;
+    uint8_t queueCount;
+    RequestHandle nextHandle;
+    CompletedRequest completed[COMPLETED_HISTORY_SIZE];
+    uint8_t completedNext;
+
+    TokenListener tokenListener;
+    JsonStreamParser tokenParser;
+    DeviceListener deviceListener;
+    JsonStreamParser deviceParser;
+    PlayerListener playerListener;
+    JsonStreamParser playerParser;
+
+    void LoadState();
+    void SaveState();
+    bool TokenExpiring();
+    bool TokenExpired();
+
+    bool ShuffleKnownOn();
+    RequestHandle QueuePlay(const char *context_uri, RequestCallback callback);
+    RequestHandle QueuePlayAndShuffle(RequestCallback callback);
+    RequestHandle CallAPI(RequestKind kind, const char *method, const char *path, const char *pathSuffix, const char *body, RequestCallback callback, bool pipelined = false);
+    void Step();
+    void Start(PendingRequest &pending);
+    void Complete();
+    void ApplyToken(int httpCode);
+    void ApplyDevices(int httpCode);
+    void ApplyPlayer(int httpCode);
+    void PlayFinished(uint16_t tap, int httpCode);
+    void FinishTap(uint16_t tap, int httpCode);
+    int Await(RequestHandle handle);
+};
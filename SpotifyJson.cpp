@@ -0,0 +1,143 @@
+#include "SpotifyJson.h"
+
+void TokenListener::Reset()
+{
+    accessToken = "";
+    refreshToken = "";
+    expiresIn = 0;
+}
+
+void TokenListener::Value(const char *key, const char *value, uint8_t depth)
+{
+    if (depth != 1)
+    {
+        return;
+    }
+    if (strcmp(key, "access_token") == 0)
+    {
+        accessToken = value;
+    }
+    else if (strcmp(key, "expires_in") == 0)
+    {
+        expiresIn = atol(value);
+    }
+    else if (strcmp(key, "refresh_token") == 0)
+    {
+        refreshToken = value;
+    }
+}
+
+void DeviceListener::Reset()
+{
+    found = false;
+    deviceId[0] = '\0';
+    id[0] = '\0';
+    matches = false;
+}
+
+void DeviceListener::StartContainer(const char *key, uint8_t depth)
+{
+    if (depth == 3)
+    {
+        id[0] = '\0';
+        matches = false;
+    }
+}
+
+void DeviceListener::Value(const char *key, const char *value, uint8_t depth)
+{
+    if (depth != 3)
+    {
+        return;
+    }
+    if (strcmp(key, "id") == 0)
+    {
+        strncpy(id, value, sizeof(id) - 1);
+        id[sizeof(id) - 1] = '\0';
+    }
+    else if (strcmp(key, "name") == 0)
+    {
+        matches = name == value;
+    }
+}
+
+void DeviceListener::EndContainer(uint8_t depth)
+{
+    if (depth == 3 && matches && !found)
+    {
+        found = true;
+        memcpy(deviceId, id, sizeof(id));
+    }
+}
+
+void PlayerListener::Reset()
+{
+    playing = false;
+    shuffle = false;
+    hasShuffle = false;
+    progressMs = 0;
+    durationMs = 0;
+    trackId[0] = '\0';
+    deviceId[0] = '\0';
+    inItem = false;
+    inDevice = false;
+}
+
+void PlayerListener::StartContainer(const char *key, uint8_t depth)
+{
+    if (depth == 2 && strcmp(key, "item") == 0)
+    {
+        inItem = true;
+    }
+    else if (depth == 2 && strcmp(key, "device") == 0)
+    {
+        inDevice = true;
+    }
+}
+
+void PlayerListener::Value(const char *key, const char *value, uint8_t depth)
+{
+    if (depth == 1)
+    {
+        if (strcmp(key, "is_playing") == 0)
+        {
+            playing = strcmp(value, "true") == 0;
+        }
+        else if (strcmp(key, "progress_ms") == 0)
+        {
+            progressMs = strtoul(value, nullptr, 10);
+        }
+        else if (strcmp(key, "shuffle_state") == 0)
+        {
+            shuffle = strcmp(value, "true") == 0;
+            hasShuffle = true;
+        }
+    }
+    // device and context sit at the same depth and have ids of their own
+    else if (depth == 2 && inItem)
+    {
+        if (strcmp(key, "id") == 0)
+        {
+            strncpy(trackId, value, sizeof(trackId) - 1);
+            trackId[sizeof(trackId) - 1] = '\0';
+        }
+        else if (strcmp(key, "duration_ms") == 0)
+        {
+            durationMs = strtoul(value, nullptr, 10);
+        }
+    }
+    else if (depth == 2 && inDevice && strcmp(key, "id") == 0)
+    {
+        strncpy(deviceId, value, sizeof(deviceId) - 1);
+        deviceId[sizeof(deviceId) - 1] = '\0';
+    }
+}
+
+void PlayerListener::EndContainer(uint8_t depth)
+{
+    if (depth == 2)
+    {
+        inItem = false;
+        inDevice = false;
+    }
+}
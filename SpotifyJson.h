@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include "JsonStreamParser.h"
+
+// Spotify ids are 22 base62 characters
+#define TRACK_ID_SIZE 32
+
+// Picks access_token, expires_in and a rotated refresh_token out of the /api/token response
+class TokenListener : public JsonListener
+{
+public:
+    String accessToken;
+    String refreshToken;
+    long expiresIn;
+
+    TokenListener() { Reset(); }
+    void Reset();
+    void Value(const char *key, const char *value, uint8_t depth) override;
+};
+
+// Walks devices[] of /v1/me/player/devices looking for the device called name
+class DeviceListener : public JsonListener
+{
+public:
+    bool found;
+    char deviceId[48];
+
+    DeviceListener(const String &name) : name(name) { Reset(); }
+    void Reset();
+    void StartContainer(const char *key, uint8_t depth) override;
+    void Value(const char *key, const char *value, uint8_t depth) override;
+    void EndContainer(uint8_t depth) override;
+
+private:
+    const String &name;
+    char id[48];
+    bool matches;
+};
+
+// Keeps is_playing, progress_ms, shuffle_state, the id of device and the id
+// and duration_ms of item out of /v1/me/player, everything else streams past
+class PlayerListener : public JsonListener
+{
+public:
+    bool playing;
+    bool shuffle;
+    bool hasShuffle;
+    unsigned long progressMs;
+    unsigned long durationMs;
+    char trackId[TRACK_ID_SIZE];
+    char deviceId[48];
+
+    PlayerListener() { Reset(); }
+    void Reset();
+    void StartContainer(const char *key, uint8_t depth) override;
+    void Value(const char *key, const char *value, uint8_t depth) override;
+    void EndContainer(uint8_t depth) override;
+
+private:
+    bool inItem;
+    bool inDevice;
+};
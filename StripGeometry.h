@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdint.h>
+#include "PixelOutput.h"
+
+enum StripShape : uint8_t
+{
+    StripLine,
+    StripRing
+};
+
+// How effect positions land on the physical strip, fixed at compile time.
+// On a ring Offset turns position 0 to that pixel, wrapping around; a line
+// has ends and always starts at its first pixel. A mirrored strip shows the
+// effect twice, from the middle outwards, so it has half as many
+// positions, each lighting two pixels.
+template <uint16_t Count, StripShape Shape = StripLine, uint16_t Offset = 0, bool Mirrored = false>
+struct StripGeometry
+{
+    static_assert(Count > 0, "A strip needs pixels");
+    static_assert(Offset < Count, "Offset must be on the strip");
+    static_assert(Shape == StripRing || Offset == 0, "Only a ring can be turned, a line starts at its first pixel");
+
+    static constexpr uint16_t count = Count;
+    static constexpr StripShape shape = Shape;
+    static constexpr bool mirrored = Mirrored;
+    static constexpr uint16_t positions = Mirrored ? (Count + 1) / 2 : Count;
+
+    struct Table
+    {
+        uint16_t first[positions];
+        uint16_t second[positions];
+    };
+
+    static constexpr uint16_t Rotate(uint16_t index) { return (index + Offset) % Count; }
+
+    static constexpr Table MakeTable()
+    {
+        Table table{};
+        for (uint16_t position = 0; position < positions; position++)
+        {
+            if (Mirrored)
+            {
+                // centre pixels first, an odd strip shares its middle one
+                uint16_t upper = Count / 2 + position;
+                uint16_t lower = (Count - 1) / 2 - position;
+                table.first[position] = Rotate(upper);
+                table.second[position] = Rotate(lower);
+            }
+            else
+            {
+                table.first[position] = Rotate(position);
+                table.second[position] = Rotate(position);
+            }
+        }
+        return table;
+    }
+
+    static constexpr Table table = MakeTable();
+};
+
+// Lets effects draw by position on any geometry. The geometry's pixel
+// tables are built by the compiler, so a position costs one lookup. Given
+// the concrete output, a final class like LedRenderer, an effect drawing on
+// the layout by its own type makes no virtual call at all.
+template <typename Geometry, typename Output = PixelOutput>
+class StripLayout final : public PixelOutput
+{
+public:
+    StripLayout(Output &output) : output(output) {}
+
+    uint16_t Count() const override { return Geometry::positions; }
+    void SetPixel(uint16_t position, uint32_t color) override
+    {
+        if (position < Geometry::positions)
+        {
+            output.SetPixel(Geometry::table.first[position], color);
+            if (Geometry::mirrored)
+            {
+                output.SetPixel(Geometry::table.second[position], color);
+            }
+        }
+    }
+    void Show() override { output.Show(); }
+
+private:
+    Output &output;
+};
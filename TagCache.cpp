@@ -0,0 +1,133 @@
+#include "TagCache.h"
+
+TagCache::TagCache()
+{
+    memset(entries, 0, sizeof(entries));
+    tick = 0;
+    hits = 0;
+    misses = 0;
+    invalidations = 0;
+    store = nullptr;
+}
+
+void TagCache::SetStore(fs::FS *fs)
+{
+    store = fs;
+    if (store)
+    {
+        Load();
+    }
+}
+
+TagCacheEntry *TagCache::Find(const uint8_t *uid, uint8_t uidSize)
+{
+    TagCacheEntry *entry = Lookup(uid, uidSize);
+    if (!entry)
+    {
+        misses++;
+    }
+    return entry;
+}
+
+TagCacheEntry *TagCache::Lookup(const uint8_t *uid, uint8_t uidSize)
+{
+    for (TagCacheEntry &entry : entries)
+    {
+        if (entry.uidSize != 0 && entry.uidSize == uidSize && memcmp(entry.uid, uid, uidSize) == 0)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void TagCache::Hit(TagCacheEntry &entry)
+{
+    // recency is kept in RAM only, writing flash on every tap would wear it out
+    hits++;
+    entry.lastUsed = ++tick;
+}
+
+void TagCache::Invalidate(TagCacheEntry &entry)
+{
+    misses++;
+    invalidations++;
+    entry.uidSize = 0;
+    Save();
+}
+
+void TagCache::Store(const uint8_t *uid, uint8_t uidSize, uint8_t checkPage, uint32_t checksum, const char *uri)
+{
+    if (uidSize > TAG_UID_SIZE || strlen(uri) >= TAG_CACHE_URI_SIZE)
+    {
+        return;
+    }
+
+    TagCacheEntry *slot = Lookup(uid, uidSize);
+    if (!slot)
+    {
+        // free slots have lastUsed 0 and go first
+        slot = &entries[0];
+        for (TagCacheEntry &entry : entries)
+        {
+            if (entry.uidSize == 0)
+            {
+                slot = &entry;
+                break;
+            }
+            if (entry.lastUsed < slot->lastUsed)
+            {
+                slot = &entry;
+            }
+        }
+    }
+
+    slot->uidSize = uidSize;
+    memcpy(slot->uid, uid, uidSize);
+    slot->checkPage = checkPage;
+    slot->checksum = checksum;
+    slot->lastUsed = ++tick;
+    strcpy(slot->uri, uri);
+    Save();
+}
+
+void TagCache::Load()
+{
+    File file = store->open(TAG_CACHE_FILE, "r");
+    if (!file)
+    {
+        return;
+    }
+    uint32_t magic = 0;
+    if (file.size() == sizeof(magic) + sizeof(entries) &&
+        file.read(reinterpret_cast<uint8_t *>(&magic), sizeof(magic)) == sizeof(magic) && magic == TAG_CACHE_MAGIC)
+    {
+        file.read(reinterpret_cast<uint8_t *>(entries), sizeof(entries));
+        for (TagCacheEntry &entry : entries)
+        {
+            entry.uri[TAG_CACHE_URI_SIZE - 1] = '\0';
+            if (entry.lastUsed > tick)
+            {
+                tick = entry.lastUsed;
+            }
+        }
+    }
+    file.close();
+}
+
+void TagCache::Save()
+{
+    if (!store)
+    {
+        return;
+    }
+    File file = store->open(TAG_CACHE_FILE, "w");
+    if (!file)
+    {
+        return;
+    }
+    uint32_t magic = TAG_CACHE_MAGIC;
+    file.write(reinterpret_cast<const uint8_t *>(&magic), sizeof(magic));
+    file.write(reinterpret_cast<const uint8_t *>(entries), sizeof(entries));
+    file.close();
+}
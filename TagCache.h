@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include "TagPresence.h"
+
+#define TAG_CACHE_SIZE 8
+#define TAG_CACHE_URI_SIZE 96
+#define TAG_CACHE_FILE "/tag_cache"
+#define TAG_CACHE_MAGIC 0x54414731
+
+struct TagCacheEntry
+{
+    uint8_t uidSize;
+    uint8_t uid[TAG_UID_SIZE];
+    // first page of the four page block that ends the NDEF message
+    uint8_t checkPage;
+    uint32_t checksum;
+    uint32_t lastUsed;
+    char uri[TAG_CACHE_URI_SIZE];
+};
+
+// Remembers which spotify URI a card resolved to, keyed by its UID, so a
+// repeat tap only has to read back one block to confirm the tag was not
+// rewritten. Least recently used entries make room for new cards. With a
+// store set the entries survive a reboot.
+class TagCache
+{
+public:
+    TagCache();
+
+    void SetStore(fs::FS *fs);
+
+    // A lookup ends in Hit() or counts as a miss: no entry here, or one that
+    // had to be invalidated
+    TagCacheEntry *Find(const uint8_t *uid, uint8_t uidSize);
+    void Hit(TagCacheEntry &entry);
+    void Invalidate(TagCacheEntry &entry);
+    void Store(const uint8_t *uid, uint8_t uidSize, uint8_t checkPage, uint32_t checksum, const char *uri);
+
+    unsigned long GetHits() const { return hits; }
+    unsigned long GetMisses() const { return misses; }
+    unsigned long GetInvalidations() const { return invalidations; }
+
+private:
+    TagCacheEntry entries[TAG_CACHE_SIZE];
+    uint32_t tick;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long invalidations;
+    fs::FS *store;
+
+    TagCacheEntry *Lookup(const uint8_t *uid, uint8_t uidSize);
+    void Load();
+    void Save();
+};
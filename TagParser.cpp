@@ -0,0 +1,211 @@
+#include <string.h>
+#include "TagParser.h"
+
+// URI identifier codes of the NFC Forum URI record type
+static const char *const uriPrefixes[] = {
+    "",
+    "http://www.",
+    "https://www.",
+    "http://",
+    "https://",
+    "tel:",
+    "mailto:",
+    "ftp://anonymous:anonymous@",
+    "ftp://ftp.",
+    "ftps://",
+    "sftp://",
+    "smb://",
+    "nfs://",
+    "ftp://",
+    "dav://",
+    "news:",
+    "telnet://",
+    "imap:",
+    "rtsp://",
+    "urn:",
+    "pop:",
+    "sip:",
+    "sips:",
+    "tftp:",
+    "btspp://",
+    "btl2cap://",
+    "btgoep://",
+    "tcpobex://",
+    "irdaobex://",
+    "file://",
+    "urn:epc:id:",
+    "urn:epc:tag:",
+    "urn:epc:pat:",
+    "urn:epc:raw:",
+    "urn:epc:",
+    "urn:nfc:",
+};
+
+static bool StartsWith(const char *text, const char *prefix)
+{
+    return strncmp(text, prefix, strlen(prefix)) == 0;
+}
+
+// Joins prefix and the record bytes into a C string, cut at link's size
+static void JoinLink(const char *prefix, const uint8_t *data, size_t size, char *link, size_t linkSize)
+{
+    size_t length = 0;
+    for (; prefix[length] != '\0' && length < linkSize - 1; length++)
+    {
+        link[length] = prefix[length];
+    }
+    for (size_t i = 0; i < size && length < linkSize - 1; i++)
+    {
+        link[length++] = (char)data[i];
+    }
+    link[length] = '\0';
+}
+
+bool NormalizeSpotifyUri(const char *link, char *uri, size_t uriSize)
+{
+    const char prefix[] = "spotify:";
+    size_t length = sizeof(prefix) - 1;
+    if (uriSize <= length)
+    {
+        return false;
+    }
+
+    if (StartsWith(link, prefix))
+    {
+        link += length;
+    }
+    else
+    {
+        if (StartsWith(link, "https://"))
+        {
+            link += 8;
+        }
+        else if (StartsWith(link, "http://"))
+        {
+            link += 7;
+        }
+        if (StartsWith(link, "www."))
+        {
+            link += 4;
+        }
+        if (!StartsWith(link, "open.spotify.com/"))
+        {
+            return false;
+        }
+        link += 17;
+
+        // localized links carry the market in front of the path
+        if (StartsWith(link, "intl-"))
+        {
+            const char *slash = strchr(link, '/');
+            if (!slash)
+            {
+                return false;
+            }
+            link = slash + 1;
+        }
+    }
+
+    memcpy(uri, prefix, length);
+    for (; *link != '\0' && *link != '?' && *link != '#' && length < uriSize - 1; link++)
+    {
+        uri[length++] = *link == '/' ? ':' : *link;
+    }
+    // a trailing slash leaves an empty segment
+    if (uri[length - 1] == ':')
+    {
+        length--;
+    }
+    uri[length] = '\0';
+    return length > sizeof(prefix) - 1;
+}
+
+bool ParseTagUri(const uint8_t *message, size_t size, char *uri, size_t uriSize)
+{
+    char link[NDEF_URI_SIZE];
+    size_t offset = 0;
+    while (offset + 3 <= size)
+    {
+        uint8_t header = message[offset];
+        bool lastRecord = header & 0x40;
+        bool chunked = header & 0x20;
+        bool shortRecord = header & 0x10;
+        bool hasId = header & 0x08;
+        uint8_t tnf = header & 0x07;
+
+        size_t typeLength = message[offset + 1];
+        size_t position = offset + 2;
+        size_t payloadLength;
+        if (shortRecord)
+        {
+            payloadLength = message[position++];
+        }
+        else
+        {
+            if (position + 4 > size)
+            {
+                return false;
+            }
+            payloadLength = ((size_t)message[position] << 24) | ((size_t)message[position + 1] << 16) |
+                            ((size_t)message[position + 2] << 8) | message[position + 3];
+            position += 4;
+        }
+        size_t idLength = 0;
+        if (hasId)
+        {
+            if (position >= size)
+            {
+                return false;
+            }
+            idLength = message[position++];
+        }
+
+        const uint8_t *type = message + position;
+        size_t payloadOffset = position + typeLength + idLength;
+        if (payloadOffset > size || payloadLength > size - payloadOffset)
+        {
+            // record runs past what was read from the tag
+            return false;
+        }
+        const uint8_t *payload = message + payloadOffset;
+        offset = payloadOffset + payloadLength;
+
+        // chunked payloads would have to be reassembled, no Spotify writer produces them
+        link[0] = '\0';
+        if (!chunked && tnf == NDEF_TNF_WELL_KNOWN && typeLength == 1 && type[0] == 'U' && payloadLength > 0)
+        {
+            const char *prefix = payload[0] < sizeof(uriPrefixes) / sizeof(uriPrefixes[0]) ? uriPrefixes[payload[0]] : "";
+            JoinLink(prefix, payload + 1, payloadLength - 1, link, sizeof(link));
+        }
+        else if (!chunked && tnf == NDEF_TNF_WELL_KNOWN && typeLength == 1 && type[0] == 'T' && payloadLength > 0)
+        {
+            // status byte holds the encoding and the length of the language code
+            size_t languageLength = payload[0] & 0x3F;
+            bool utf16 = payload[0] & 0x80;
+            if (!utf16 && 1 + languageLength <= payloadLength)
+            {
+                JoinLink("", payload + 1 + languageLength, payloadLength - 1 - languageLength, link, sizeof(link));
+            }
+        }
+        else if (!chunked && tnf == NDEF_TNF_ABSOLUTE_URI)
+        {
+            JoinLink("", type, typeLength, link, sizeof(link));
+        }
+
+        // spotify.link short links only resolve through an HTTP redirect and are skipped
+        if (link[0] != '\0' && NormalizeSpotifyUri(link, uri, uriSize))
+        {
+            return true;
+        }
+
+        if (lastRecord)
+        {
+            break;
+        }
+    }
+    if (uriSize > 0)
+    {
+        uri[0] = '\0';
+    }
+    return false;
+}
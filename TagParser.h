@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest URI taken from a record before it is normalized
+#define NDEF_URI_SIZE 160
+
+#define NDEF_TNF_WELL_KNOWN 0x01
+#define NDEF_TNF_ABSOLUTE_URI 0x03
+
+// Finds the first record of an NDEF message that names something on Spotify
+// and writes it to uri as a "spotify:<type>:<id>" URI. URI, text and absolute
+// URI records are understood, in short or long form. Nothing is allocated.
+bool ParseTagUri(const uint8_t *message, size_t size, char *uri, size_t uriSize);
+
+// Turns "spotify:...", "https://open.spotify.com/[intl-xx/]<type>/<id>?si=..."
+// and bare "open.spotify.com/..." links into a spotify URI.
+bool NormalizeSpotifyUri(const char *link, char *uri, size_t uriSize);
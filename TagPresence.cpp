@@ -0,0 +1,43 @@
+#include <string.h>
+#include "TagPresence.h"
+
+TagPresence::TagPresence()
+{
+    present = false;
+    uidSize = 0;
+    misses = 0;
+    inserts = 0;
+    suppressed = 0;
+}
+
+TagEvent TagPresence::Update(const uint8_t *uid, uint8_t uidSize)
+{
+    if (!uid || uidSize == 0 || uidSize > TAG_UID_SIZE)
+    {
+        if (present && ++misses >= TAG_REMOVE_MISSES)
+        {
+            present = false;
+            return TagRemoved;
+        }
+        return TagNone;
+    }
+
+    bool same = present && this->uidSize == uidSize && memcmp(this->uid, uid, uidSize) == 0;
+    if (same)
+    {
+        // back after a short dropout, this used to restart playback
+        if (misses > 0)
+        {
+            suppressed++;
+        }
+        misses = 0;
+        return TagNone;
+    }
+
+    present = true;
+    misses = 0;
+    this->uidSize = uidSize;
+    memcpy(this->uid, uid, uidSize);
+    inserts++;
+    return TagInserted;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest UID a card can report (triple size)
+#define TAG_UID_SIZE 10
+// Polls in a row a card has to be missing before it counts as removed
+#define TAG_REMOVE_MISSES 3
+
+enum TagEvent : uint8_t
+{
+    TagNone,
+    TagInserted,
+    TagRemoved
+};
+
+// Follows which card sits on the reader across polls. Only a new card is
+// reported as inserted, a card that stays put or drops out for fewer than
+// TAG_REMOVE_MISSES polls while being wobbled is not.
+class TagPresence
+{
+public:
+    TagPresence();
+
+    // uid is nullptr when no card answered the poll
+    TagEvent Update(const uint8_t *uid, uint8_t uidSize);
+    // the card on the reader is reported as inserted again on its next poll
+    void Forget() { present = false; }
+
+    bool Present() const { return present; }
+    unsigned long GetInserts() const { return inserts; }
+    unsigned long GetSuppressed() const { return suppressed; }
+
+private:
+    bool present;
+    uint8_t uid[TAG_UID_SIZE];
+    uint8_t uidSize;
+    uint8_t misses;
+    unsigned long inserts;
+    unsigned long suppressed;
+};
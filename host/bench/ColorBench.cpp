@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include <Adafruit_NeoPixel.h>
+#include "ColorReference.h"
+#include "ColorTable.h"
+
+// An 8 pixel spectrum frame turned into colors: through the flash tables,
+// through float HSV and pow() gamma as it would be done at run time, and
+// through the NeoPixel library's ColorHSV and gamma32 the sketch once used.
+
+static const uint8_t levels[8] = {12, 240, 97, 180, 33, 255, 0, 140};
+
+static void BM_AmplitudeColorTable(benchmark::State &state)
+{
+    uint32_t colors[8];
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            colors[i] = AmplitudeColor(levels[i]);
+        }
+        benchmark::DoNotOptimize(colors);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * 8);
+}
+BENCHMARK(BM_AmplitudeColorTable);
+
+static void BM_AmplitudeColorFloat(benchmark::State &state)
+{
+    uint32_t colors[8];
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            uint8_t level = levels[i];
+            benchmark::DoNotOptimize(level);
+            colors[i] = FloatAmplitudeColor(level);
+        }
+        benchmark::DoNotOptimize(colors);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * 8);
+}
+BENCHMARK(BM_AmplitudeColorFloat);
+
+static void BM_ColorHSV(benchmark::State &state)
+{
+    uint32_t colors[8];
+    for (auto _ : state)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            uint8_t level = levels[i];
+            benchmark::DoNotOptimize(level);
+            colors[i] = Adafruit_NeoPixel::gamma32(Adafruit_NeoPixel::ColorHSV((170 - level * 170 / 255) * 256, 255, level));
+        }
+        benchmark::DoNotOptimize(colors);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * 8);
+}
+BENCHMARK(BM_ColorHSV);
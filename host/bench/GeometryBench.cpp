@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+#include <Adafruit_NeoPixel.h>
+#include "LedRenderer.h"
+#include "NeoPixelOutput.h"
+#include "SoundReactive.h"
+#include "StripGeometry.h"
+
+// One sound frame drawn on each geometry, render only: the renderer keeps
+// the frame until its next flush, so this is the effect, the layout and the
+// renderer's pixel store and nothing of the strip.
+
+static void Levels(uint8_t *bands, uint8_t frame)
+{
+    for (int i = 0; i < SOUND_BANDS; i++)
+    {
+        bands[i] = (uint8_t)(frame * 37 + i * 29);
+    }
+}
+
+template <typename Geometry>
+static void BM_SoundRender(benchmark::State &state)
+{
+    Adafruit_NeoPixel strip(Geometry::count, 4, NEO_GRB + NEO_KHZ800);
+    NeoPixelOutput output(strip);
+    LedRenderer renderer(output, 30);
+    StripLayout<Geometry, LedRenderer> layout(renderer);
+    SoundReactive sound;
+    uint8_t bands[SOUND_BANDS];
+    uint8_t frame = 0;
+    for (auto _ : state)
+    {
+        Levels(bands, frame++);
+        sound.Bands(bands);
+        sound.Render(layout);
+    }
+    state.SetItemsProcessed(state.iterations() * Geometry::count);
+}
+BENCHMARK_TEMPLATE(BM_SoundRender, StripGeometry<8, StripRing, 1>);
+BENCHMARK_TEMPLATE(BM_SoundRender, StripGeometry<16, StripRing>);
+BENCHMARK_TEMPLATE(BM_SoundRender, StripGeometry<24, StripRing, 0, true>);
+BENCHMARK_TEMPLATE(BM_SoundRender, StripGeometry<30, StripLine, 0, true>);
+BENCHMARK_TEMPLATE(BM_SoundRender, StripGeometry<60, StripRing, 5>);
+
+// The 60 pixel ring the way it was drawn before the layout knew its output:
+// the band divided out per pixel and two virtual calls down to the store
+static void BM_SoundRenderVirtual(benchmark::State &state)
+{
+    Adafruit_NeoPixel strip(60, 4, NEO_GRB + NEO_KHZ800);
+    NeoPixelOutput output(strip);
+    LedRenderer renderer(output, 30);
+    StripLayout<StripGeometry<60, StripRing, 5>> layout(renderer);
+    PixelOutput &target = layout;
+    uint8_t bands[SOUND_BANDS];
+    uint8_t frame = 0;
+    for (auto _ : state)
+    {
+        Levels(bands, frame++);
+        uint16_t count = target.Count();
+        for (uint16_t position = 0; position < count; position++)
+        {
+            int level = bands[position * SOUND_BANDS / count] + 32;
+            target.SetPixel(position, AmplitudeColor(level > 255 ? 255 : level));
+        }
+        target.Show();
+    }
+    state.SetItemsProcessed(state.iterations() * 60);
+}
+BENCHMARK(BM_SoundRenderVirtual);
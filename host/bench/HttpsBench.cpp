@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+#include "HttpRequest.h"
+#include "Host.h"
+#include "HostNetwork.h"
+
+namespace
+{
+    class PlayServer : public HostServer
+    {
+    public:
+        bool closeEach = false;
+
+        void Handle(const HostHttpRequest &request, HostHttpResponse &response) override
+        {
+            response.status = 204;
+            response.close = closeEach;
+        }
+    };
+}
+
+// A play command on api.spotify.com, in simulated milliseconds per request.
+// keepAlive reuses the pooled socket, otherwise the server closes it after
+// every answer and the next request reconnects, resuming the TLS session
+// when the server allows it. No reuse and no resumption is how every request
+// went out before the pool.
+static void BM_ApiRequest(benchmark::State &state, bool keepAlive, bool resumption)
+{
+    Host::Reset();
+    PlayServer server;
+    server.closeEach = !keepAlive;
+    server.resumption = resumption;
+    Host::AddServer(SPOTIFY_API_HOST, &server);
+    ConnectionPool pool;
+    HttpRequest request(pool);
+
+    for (auto _ : state)
+    {
+        uint64_t start = Host::Now();
+        request.Begin("PUT", SPOTIFY_API_HOST, "/v1/me/player/play?device_id=5fbb3ba6", "Bearer", "token", "application/json",
+                      "{\"context_uri\":\"spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ\"}", nullptr);
+        // one Step() per millisecond, the sketch's loop() cadence
+        while (request.Step())
+        {
+            Host::Advance(1000);
+        }
+        state.SetIterationTime((Host::Now() - start) / 1e6);
+    }
+
+    state.counters["hits"] = pool.GetHits();
+    state.counters["misses"] = pool.GetMisses();
+    state.counters["full"] = server.fullHandshakes;
+    state.counters["resumed"] = server.resumedHandshakes;
+    Host::RemoveServers();
+}
+BENCHMARK_CAPTURE(BM_ApiRequest, reused, true, true)->UseManualTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ApiRequest, reconnect_resumed, false, true)->UseManualTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ApiRequest, reconnect_full, false, false)->UseManualTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,139 @@
+#include <benchmark/benchmark.h>
+#include "HeapStats.h"
+#include "JsonReference.h"
+#include "MockSpotify.h"
+#include "SpotifyJson.h"
+
+// Parse time and peak heap of the recorded payloads. Streamed is how the
+// client parses them, chunk by chunk as they come off the socket. Reference
+// is the code it replaced: the body collected into a String the way
+// HTTPClient::getString() did, then handed by value to the old charAt()
+// parsers in JsonReference.
+
+// The payloads without the whitespace between tokens, as Spotify sends
+// them; the old parser took the space after a colon for the value
+static std::string Compact(const std::string &body)
+{
+    std::string compact;
+    bool inString = false;
+    for (size_t i = 0; i < body.size(); i++)
+    {
+        char c = body[i];
+        if (inString)
+        {
+            inString = !(c == '"' && body[i - 1] != '\\');
+        }
+        else if (c == '"')
+        {
+            inString = true;
+        }
+        else if (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+        {
+            continue;
+        }
+        compact += c;
+    }
+    return compact;
+}
+
+template <typename Listener>
+static void Stream(Listener &listener, JsonStreamParser &parser, const std::string &body)
+{
+    listener.Reset();
+    parser.Reset();
+    for (size_t offset = 0; offset < body.size(); offset += 512)
+    {
+        parser.write(reinterpret_cast<const uint8_t *>(body.data() + offset), body.size() - offset < 512 ? body.size() - offset : 512);
+    }
+}
+
+static String Collect(const std::string &body)
+{
+    String payload;
+    for (size_t offset = 0; offset < body.size(); offset += 512)
+    {
+        payload.concat(body.data() + offset, body.size() - offset < 512 ? body.size() - offset : 512);
+    }
+    return payload;
+}
+
+// runs parse once under HeapStats for the counters, then timed
+template <typename Parse>
+static void Measure(benchmark::State &state, const std::string &body, Parse parse)
+{
+    HeapStats::Begin();
+    parse();
+    HeapStats::End();
+    state.counters["peak_heap"] = HeapStats::PeakBytes();
+    state.counters["allocations"] = HeapStats::Allocations();
+
+    for (auto _ : state)
+    {
+        parse();
+    }
+    state.SetBytesProcessed(state.iterations() * body.size());
+}
+
+static void BM_TokenPayload(benchmark::State &state, bool streamed)
+{
+    std::string body = Compact(ReadDataFile("token.json"));
+    TokenListener listener;
+    JsonStreamParser parser(listener);
+    Stream(listener, parser, body);
+    if (ReferenceParseJson("access_token", Collect(body)) != listener.accessToken)
+    {
+        state.SkipWithError("the parsers disagree");
+        return;
+    }
+
+    if (streamed)
+    {
+        Measure(state, body, [&]
+                { Stream(listener, parser, body); });
+        return;
+    }
+    Measure(state, body, [&]
+            {
+                String payload = Collect(body);
+                benchmark::DoNotOptimize(ReferenceParseJson("access_token", payload)); });
+}
+BENCHMARK_CAPTURE(BM_TokenPayload, streamed, true);
+BENCHMARK_CAPTURE(BM_TokenPayload, reference, false);
+
+static void BM_DevicesPayload(benchmark::State &state, bool streamed)
+{
+    std::string body = Compact(ReadDataFile("devices.json"));
+    String name = "Echo en la Glasgow";
+    DeviceListener listener(name);
+    JsonStreamParser parser(listener);
+    Stream(listener, parser, body);
+    if (!listener.found || ReferenceGetDeviceId(name, Collect(body)) != listener.deviceId)
+    {
+        state.SkipWithError("the parsers disagree");
+        return;
+    }
+
+    if (streamed)
+    {
+        Measure(state, body, [&]
+                { Stream(listener, parser, body); });
+        return;
+    }
+    Measure(state, body, [&]
+            {
+                String payload = Collect(body);
+                benchmark::DoNotOptimize(ReferenceGetDeviceId(name, payload)); });
+}
+BENCHMARK_CAPTURE(BM_DevicesPayload, streamed, true);
+BENCHMARK_CAPTURE(BM_DevicesPayload, reference, false);
+
+// /v1/me/player was never parsed before the poller, there is no reference
+static void BM_PlayerPayload(benchmark::State &state)
+{
+    std::string body = Compact(ReadDataFile("player.json"));
+    PlayerListener listener;
+    JsonStreamParser parser(listener);
+    Measure(state, body, [&]
+            { Stream(listener, parser, body); });
+}
+BENCHMARK(BM_PlayerPayload);
@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+#include <Adafruit_NeoPixel.h>
+#include "NeoPixelBusOutput.h"
+#include "NeoPixelOutput.h"
+
+// CPU per frame for each LED backend: a frame of pixels set and Show()
+// called. The NeoPixelBus shim does the encoding its method does before
+// the peripheral takes over; the Adafruit shim does nothing in show(), on
+// the board that is the bit-bang. What the host cannot time is how long
+// the CPU then waits for the wire, 30 us a pixel at 800 kbps. That goes
+// into blocked_us from what each method is known to do: the bit-bang waits
+// it all out, the synchronous UART all but the last FIFO full, DMA and the
+// async UART none of it.
+
+static double WireMicros(uint16_t count)
+{
+    return count * 24 * 1.25;
+}
+
+// a pixel is twelve UART frames of six data bits, eight with start and
+// stop, at 3.2 Mbaud; Show() returns once the last is in the 128 byte FIFO
+static double UartBlockedMicros(uint16_t count)
+{
+    long beyond = count * 12L - 128;
+    return beyond > 0 ? beyond * 8 / 3.2 : 0;
+}
+
+static uint32_t FrameColor(uint16_t pixel, uint8_t frame)
+{
+    return (uint32_t)(frame * 37 + pixel * 29) << 16 | (uint32_t)(frame * 11 + pixel) << 8 | (uint8_t)(pixel * 53);
+}
+
+template <typename Output>
+static void ShowFrames(benchmark::State &state, Output &output, uint16_t count)
+{
+    uint8_t frame = 0;
+    for (auto _ : state)
+    {
+        for (uint16_t pixel = 0; pixel < count; pixel++)
+        {
+            output.SetPixel(pixel, FrameColor(pixel, frame));
+        }
+        output.Show();
+        frame++;
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void BM_ShowAdafruit(benchmark::State &state)
+{
+    const uint16_t count = (uint16_t)state.range(0);
+    Adafruit_NeoPixel strip(count, 4, NEO_GRB + NEO_KHZ800);
+    NeoPixelOutput output(strip);
+    output.Begin(50);
+    ShowFrames(state, output, count);
+    benchmark::DoNotOptimize(strip.shows);
+    // interrupts are off for all of it
+    state.counters["blocked_us"] = WireMicros(count);
+}
+BENCHMARK(BM_ShowAdafruit)->Arg(8)->Arg(60);
+
+template <typename Method>
+static void BM_ShowNeoPixelBus(benchmark::State &state)
+{
+    const uint16_t count = (uint16_t)state.range(0);
+    NeoPixelBus<NeoGrbFeature, Method> strip(count);
+    NeoPixelBusOutput<Method> output(strip);
+    output.Begin(50);
+    ShowFrames(state, output, count);
+    benchmark::DoNotOptimize(strip.Wire().data());
+    state.counters["blocked_us"] = Method::waitsForWire ? UartBlockedMicros(count) : 0;
+}
+BENCHMARK_TEMPLATE(BM_ShowNeoPixelBus, NeoEsp8266Dma800KbpsMethod)->Arg(8)->Arg(60);
+BENCHMARK_TEMPLATE(BM_ShowNeoPixelBus, NeoEsp8266Uart1800KbpsMethod)->Arg(8)->Arg(60);
+BENCHMARK_TEMPLATE(BM_ShowNeoPixelBus, NeoEsp8266AsyncUart1800KbpsMethod)->Arg(8)->Arg(60);
@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+#include "Sketch.h"
+#include "NeoPixelOutput.h"
+#include "StripGeometry.h"
+#include "TagDump.h"
+
+// The recorded /api/token answer through the streaming parser
+static void BM_ParseToken(benchmark::State &state)
+{
+    std::string body = ReadDataFile("token.json");
+    TokenListener listener;
+    JsonStreamParser parser(listener);
+    for (auto _ : state)
+    {
+        listener.Reset();
+        parser.Reset();
+        parser.write(reinterpret_cast<const uint8_t *>(body.data()), body.size());
+        benchmark::DoNotOptimize(listener.expiresIn);
+    }
+    state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_ParseToken);
+
+// Finding the device id in the recorded /v1/me/player/devices answer
+static void BM_GetDeviceId(benchmark::State &state)
+{
+    std::string body = ReadDataFile("devices.json");
+    String name = "Echo en la Glasgow";
+    DeviceListener listener(name);
+    JsonStreamParser parser(listener);
+    for (auto _ : state)
+    {
+        listener.Reset();
+        parser.Reset();
+        parser.write(reinterpret_cast<const uint8_t *>(body.data()), body.size());
+        benchmark::DoNotOptimize(listener.found);
+    }
+    state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_GetDeviceId);
+
+// The sketch's NDEF message to URI step
+static void BM_ParseNFCTagData(benchmark::State &state)
+{
+    std::vector<uint8_t> message = UriRecord("https://open.spotify.com/intl-es/album/1ay9Z4R5ZYI2TY7WiDhNYQ?si=5b1c2a9e8f7d4c3b");
+    for (auto _ : state)
+    {
+        String uri = parseNFCTagData(message.data(), message.size());
+        benchmark::DoNotOptimize(uri.length());
+    }
+}
+BENCHMARK(BM_ParseNFCTagData);
+
+// One spectrum frame drawn on the sketch's 8 pixel ring and pushed to the strip
+static void BM_LedUpdate(benchmark::State &state)
+{
+    Adafruit_NeoPixel strip(8, 4, NEO_GRB + NEO_KHZ800);
+    NeoPixelOutput output(strip);
+    LedRenderer renderer(output, 30);
+    StripLayout<StripGeometry<8, StripRing, 1>, LedRenderer> layout(renderer);
+    SoundReactive sound;
+    uint8_t bands[SOUND_BANDS];
+    uint8_t frame = 0;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < SOUND_BANDS; i++)
+        {
+            bands[i] = (uint8_t)(frame * 37 + i * 29);
+        }
+        frame++;
+        sound.Bands(bands);
+        sound.Render(layout);
+        renderer.Flush();
+    }
+    benchmark::DoNotOptimize(strip.shows);
+}
+BENCHMARK(BM_LedUpdate);
@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+#include <math.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <vector>
+#include "AudioSampler.h"
+#include "BeatDetector.h"
+#include "Spectrum.h"
+
+// Host cycles per FFT frame, read from the time stamp counter where there
+// is one. The ESP8266's in-order core needs several times as many, so take
+// it as a lower bound; the sound task's average in the sketch's stats is
+// the figure on the device. At 25 frames a second the whole 80 MHz is
+// 3.2 M cycles a frame.
+
+static uint64_t Cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void BM_SpectrumAnalyze(benchmark::State &state)
+{
+    // a bass line with some noise on it
+    int16_t frame[FFT_SIZE];
+    for (int i = 0; i < FFT_SIZE; i++)
+    {
+        frame[i] = (int16_t)(512 + 300 * sin(2 * M_PI * 50 * i / AUDIO_SAMPLE_RATE) + (i * 37 % 17) - 8);
+    }
+    Spectrum spectrum;
+    uint8_t levels[SPECTRUM_BANDS];
+    uint64_t cycles = 0;
+    for (auto _ : state)
+    {
+        uint64_t start = Cycles();
+        spectrum.Analyze(frame, levels);
+        cycles += Cycles() - start;
+        benchmark::DoNotOptimize(levels);
+    }
+    state.counters["cycles_per_frame"] = (double)cycles / state.iterations();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SpectrumAnalyze);
+
+// The beat detector on a 120 BPM kick, every 16th frame also estimates the tempo
+static void BM_BeatDetectorUpdate(benchmark::State &state)
+{
+    const int frames = 400;
+    std::vector<std::vector<uint16_t>> magnitudes;
+    Spectrum spectrum;
+    int16_t frame[FFT_SIZE] = {};
+    uint8_t levels[SPECTRUM_BANDS];
+    for (int n = 0; n < frames * FFT_HOP; n++)
+    {
+        double since = fmod((double)n / AUDIO_SAMPLE_RATE, 0.5);
+        memmove(frame, frame + 1, (FFT_SIZE - 1) * sizeof(int16_t));
+        frame[FFT_SIZE - 1] = (int16_t)(512 + 350 * exp(-since / 0.025) * sin(2 * M_PI * 60 * since));
+        if (n % FFT_HOP == FFT_HOP - 1)
+        {
+            spectrum.Analyze(frame, levels);
+            magnitudes.emplace_back(spectrum.GetMagnitudes(), spectrum.GetMagnitudes() + FFT_SIZE / 2);
+        }
+    }
+    BeatDetector detector;
+    uint64_t cycles = 0;
+    size_t index = 0;
+    for (auto _ : state)
+    {
+        uint64_t start = Cycles();
+        benchmark::DoNotOptimize(detector.Update(magnitudes[index].data()));
+        cycles += Cycles() - start;
+        index = (index + 1) % magnitudes.size();
+    }
+    state.counters["cycles_per_frame"] = (double)cycles / state.iterations();
+    state.counters["bpm"] = detector.GetBpm() / 10.0;
+}
+BENCHMARK(BM_BeatDetectorUpdate);
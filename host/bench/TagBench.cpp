@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+#include "NfcReader.h"
+#include "TagDump.h"
+#include "TagParser.h"
+
+// A tap per recorded tag: the pages holding the NDEF message read through
+// the simulated reader, then the message turned into a spotify URI. The
+// counters are what the real reader spends, the time is only the host CPU.
+
+static void BM_ReadTag(benchmark::State &state, const char *dump)
+{
+    HostTag tag = LoadTag(dump);
+    MFRC522 mfrc522(15, 0);
+    NfcReader nfc(mfrc522);
+    mfrc522.tag = &tag;
+    char uri[NDEF_URI_SIZE];
+    unsigned long accesses = 0;
+    for (auto _ : state)
+    {
+        byte atqa[2];
+        byte atqaSize = sizeof(atqa);
+        mfrc522.PICC_WakeupA(atqa, &atqaSize);
+        mfrc522.PICC_ReadCardSerial();
+        unsigned long before = mfrc522.registerAccesses;
+        bool found = nfc.Read() == NfcOk && ParseTagUri(nfc.GetMessage(), nfc.GetMessageLength(), uri, sizeof(uri));
+        accesses = mfrc522.registerAccesses - before;
+        benchmark::DoNotOptimize(found);
+    }
+    state.counters["transactions"] = nfc.GetTransactions();
+    state.counters["register_accesses"] = accesses;
+    state.counters["bytes_read"] = nfc.GetLength();
+}
+BENCHMARK_CAPTURE(BM_ReadTag, ntag213, "ntag213.eml");
+BENCHMARK_CAPTURE(BM_ReadTag, ntag215, "ntag215.eml");
+BENCHMARK_CAPTURE(BM_ReadTag, ntag216, "ntag216.eml");
+
+// ParseTagUri alone on the message of each recorded tag
+static void BM_ParseTagUri(benchmark::State &state, const char *dump)
+{
+    HostTag tag = LoadTag(dump);
+    MFRC522 mfrc522(15, 0);
+    NfcReader nfc(mfrc522);
+    mfrc522.tag = &tag;
+    byte atqa[2];
+    byte atqaSize = sizeof(atqa);
+    mfrc522.PICC_WakeupA(atqa, &atqaSize);
+    mfrc522.PICC_ReadCardSerial();
+    if (nfc.Read() != NfcOk)
+    {
+        state.SkipWithError("tag not read");
+        return;
+    }
+    char uri[NDEF_URI_SIZE];
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(ParseTagUri(nfc.GetMessage(), nfc.GetMessageLength(), uri, sizeof(uri)));
+    }
+    state.SetBytesProcessed(state.iterations() * nfc.GetMessageLength());
+}
+BENCHMARK_CAPTURE(BM_ParseTagUri, ntag213, "ntag213.eml");
+BENCHMARK_CAPTURE(BM_ParseTagUri, ntag215, "ntag215.eml");
+BENCHMARK_CAPTURE(BM_ParseTagUri, ntag216, "ntag216.eml");
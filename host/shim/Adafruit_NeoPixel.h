@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <Arduino.h>
+
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_RGB ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_KHZ800 0x0000
+#define NEO_KHZ400 0x0100
+
+typedef uint16_t neoPixelType;
+
+// Keeps the pixels in memory and counts frames, the colour helpers are the
+// library's own arithmetic so conversions cost on the host what they cost
+// on the board relative to each other.
+class Adafruit_NeoPixel
+{
+public:
+    Adafruit_NeoPixel(uint16_t count, int16_t pin = 6, neoPixelType type = NEO_GRB + NEO_KHZ800) : pixels(count, 0) {}
+
+    void begin() {}
+    void show() { shows++; }
+    bool canShow() const { return true; }
+    void clear()
+    {
+        for (uint32_t &pixel : pixels)
+        {
+            pixel = 0;
+        }
+    }
+    void setBrightness(uint8_t brightness) { this->brightness = brightness; }
+    uint8_t getBrightness() const { return brightness; }
+    void setPixelColor(uint16_t index, uint32_t color)
+    {
+        if (index < pixels.size())
+        {
+            pixels[index] = color;
+        }
+    }
+    void setPixelColor(uint16_t index, uint8_t r, uint8_t g, uint8_t b) { setPixelColor(index, Color(r, g, b)); }
+    uint32_t getPixelColor(uint16_t index) const { return index < pixels.size() ? pixels[index] : 0; }
+    uint16_t numPixels() const { return pixels.size(); }
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+    static uint32_t ColorHSV(uint16_t hue, uint8_t saturation = 255, uint8_t value = 255);
+    static uint8_t gamma8(uint8_t x);
+    static uint32_t gamma32(uint32_t x);
+
+    // host only
+    unsigned long shows = 0;
+    // the RGB bytes the library keeps for a pixel, scaled on the way in by
+    // setBrightness() as its setPixelColor() does
+    uint32_t wireColor(uint16_t index) const
+    {
+        uint32_t color = getPixelColor(index);
+        uint8_t scale = brightness + 1;
+        if (scale == 0)
+        {
+            return color;
+        }
+        return Color(((color >> 16 & 0xFF) * scale) >> 8, ((color >> 8 & 0xFF) * scale) >> 8, ((color & 0xFF) * scale) >> 8);
+    }
+
+private:
+    std::vector<uint32_t> pixels;
+    uint8_t brightness = 255;
+};
@@ -0,0 +1,312 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <map>
+#include <vector>
+#include "Arduino.h"
+#include "Host.h"
+#include "HeapStats.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+unsigned long String::copies = 0;
+
+namespace
+{
+    struct Timer
+    {
+        Host::TimerId id;
+        uint64_t period;
+        uint64_t due;
+        bool repeat;
+        std::function<void()> callback;
+    };
+
+    uint64_t now = 0;
+    uint64_t yieldMicros = 0;
+    bool echoSerial = false;
+    bool runningTimers = false;
+    Host::TimerId nextTimer = 1;
+    // never destroyed, the sketch's global Ticker detaches on the way out after this file's globals are gone
+    std::vector<Timer> &timers = *new std::vector<Timer>();
+    std::function<int(uint8_t)> analogSource;
+    std::map<uint8_t, int> digitalPins;
+    std::map<uint8_t, void (*)()> interruptHandlers;
+    Host::TimerId timer1 = 0;
+    timercallback timer1Callback = nullptr;
+    uint32_t timer1Ticks = 0;
+    uint8_t timer1Divider = TIM_DIV16;
+    bool timer1Repeat = true;
+
+    // runs every timer due up to target, in time order
+    void RunTimers(uint64_t target)
+    {
+        if (runningTimers)
+        {
+            now = target;
+            return;
+        }
+        runningTimers = true;
+        while (true)
+        {
+            Timer *next = nullptr;
+            for (Timer &timer : timers)
+            {
+                if (timer.due <= target && (!next || timer.due < next->due))
+                {
+                    next = &timer;
+                }
+            }
+            if (!next)
+            {
+                break;
+            }
+            if (next->due > now)
+            {
+                now = next->due;
+            }
+            std::function<void()> callback = next->callback;
+            Host::TimerId id = next->id;
+            if (next->repeat && next->period > 0)
+            {
+                // one that fell behind in a stall counts its period from now
+                next->due = next->due + next->period > now ? next->due + next->period : now + next->period;
+            }
+            else
+            {
+                Host::RemoveTimer(id);
+            }
+            callback();
+        }
+        now = target > now ? target : now;
+        runningTimers = false;
+    }
+}
+
+namespace Host
+{
+    uint64_t Now() { return now; }
+
+    void Advance(uint64_t micros) { RunTimers(now + micros); }
+
+    void AdvanceMillis(unsigned long millis) { Advance((uint64_t)millis * 1000); }
+
+    void Stall(uint64_t micros) { now += micros; }
+
+    void SetYieldMicros(uint64_t micros) { yieldMicros = micros; }
+
+    void Reset()
+    {
+        now = 0;
+        yieldMicros = 0;
+        timers.clear();
+        analogSource = nullptr;
+        digitalPins.clear();
+        interruptHandlers.clear();
+        timer1 = 0;
+        timer1Callback = nullptr;
+    }
+
+    TimerId AddTimer(uint64_t periodMicros, std::function<void()> callback, bool repeat)
+    {
+        Timer timer;
+        timer.id = nextTimer++;
+        timer.period = periodMicros;
+        timer.due = now + periodMicros;
+        timer.repeat = repeat;
+        timer.callback = std::move(callback);
+        timers.push_back(std::move(timer));
+        return timers.back().id;
+    }
+
+    void RemoveTimer(TimerId id)
+    {
+        for (size_t i = 0; i < timers.size(); i++)
+        {
+            if (timers[i].id == id)
+            {
+                timers.erase(timers.begin() + i);
+                return;
+            }
+        }
+    }
+
+    void SetAnalogSource(std::function<int(uint8_t pin)> source) { analogSource = std::move(source); }
+
+    void SetDigitalPin(uint8_t pin, int value) { digitalPins[pin] = value; }
+
+    bool RaiseInterrupt(uint8_t pin)
+    {
+        auto handler = interruptHandlers.find(pin);
+        if (handler == interruptHandlers.end() || !handler->second)
+        {
+            return false;
+        }
+        handler->second();
+        return true;
+    }
+
+    void EchoSerial(bool echo) { echoSerial = echo; }
+}
+
+unsigned long millis() { return (unsigned long)(now / 1000); }
+
+unsigned long micros() { return (unsigned long)now; }
+
+void delay(unsigned long ms) { Host::AdvanceMillis(ms); }
+
+void delayMicroseconds(unsigned int us) { Host::Advance(us); }
+
+void yield() { Host::Advance(yieldMicros); }
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (mode == INPUT_PULLUP && digitalPins.find(pin) == digitalPins.end())
+    {
+        digitalPins[pin] = HIGH;
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    auto value = digitalPins.find(pin);
+    return value == digitalPins.end() ? LOW : value->second;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) { digitalPins[pin] = value; }
+
+int analogRead(uint8_t pin) { return analogSource ? analogSource(pin) : 512; }
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode) { interruptHandlers[interrupt] = handler; }
+
+void detachInterrupt(uint8_t interrupt) { interruptHandlers.erase(interrupt); }
+
+void noInterrupts() {}
+
+void interrupts() {}
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh)
+{
+    return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+}
+
+long random(long max) { return max > 0 ? rand() % max : 0; }
+
+long random(long min, long max) { return max > min ? min + random(max - min) : min; }
+
+size_t Print::print(long value, int base)
+{
+    if (value < 0 && base == 10)
+    {
+        return print('-') + print((unsigned long)-value, base);
+    }
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    char digits[66];
+    int count = 0;
+    if (base < 2)
+    {
+        base = 10;
+    }
+    do
+    {
+        int digit = value % base;
+        digits[count++] = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        value /= base;
+    } while (value > 0);
+    size_t written = 0;
+    while (count > 0)
+    {
+        written += write((uint8_t)digits[--count]);
+    }
+    return written;
+}
+
+size_t Print::print(double value, int digits)
+{
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char text[256];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(text, sizeof(text), format, arguments);
+    va_end(arguments);
+    if (length < 0)
+    {
+        return 0;
+    }
+    return write(text, (size_t)length < sizeof(text) ? length : sizeof(text) - 1);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (echoSerial)
+    {
+        fputc(c, stdout);
+    }
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (echoSerial)
+    {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+uint32_t EspClass::getFreeHeap() { return HeapStats::Tracking() ? HeapStats::FreeBytes() : 40000; }
+
+uint32_t EspClass::getMaxFreeBlockSize() { return HeapStats::Tracking() ? HeapStats::LargestFreeBlock() : 40000; }
+
+uint8_t EspClass::getHeapFragmentation()
+{
+    uint32_t free = getFreeHeap();
+    return free ? 100 - getMaxFreeBlockSize() * 100 / free : 0;
+}
+
+// 80 MHz
+uint32_t EspClass::getCycleCount() { return (uint32_t)(now * 80); }
+
+void timer1_attachInterrupt(timercallback callback) { timer1Callback = callback; }
+
+void timer1_detachInterrupt() { timer1Callback = nullptr; }
+
+void timer1_enable(uint8_t divider, uint8_t interruptType, uint8_t reload)
+{
+    timer1Divider = divider;
+    timer1Repeat = reload == TIM_LOOP;
+}
+
+void timer1_disable()
+{
+    if (timer1)
+    {
+        Host::RemoveTimer(timer1);
+        timer1 = 0;
+    }
+}
+
+void timer1_write(uint32_t ticks)
+{
+    timer1_disable();
+    timer1Ticks = ticks;
+    // 80 MHz divided by 1, 16 or 256
+    uint64_t divider = timer1Divider == TIM_DIV1 ? 1 : timer1Divider == TIM_DIV16 ? 16 : 256;
+    uint64_t period = (uint64_t)ticks * divider / 80;
+    timer1 = Host::AddTimer(period > 0 ? period : 1, []
+                            {
+                                if (timer1Callback)
+                                {
+                                    timer1Callback();
+                                } },
+                            timer1Repeat);
+}
@@ -0,0 +1,305 @@
+#pragma once
+
+// Host stand-in for the ESP8266 Arduino core. Only what the sketch and its
+// classes use is here, time and I/O are simulated through Host.h.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define PSTR(text) (text)
+#define F(text) (reinterpret_cast<const __FlashStringHelper *>(PSTR(text)))
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+
+#define A0 17
+#define INPUT 0x00
+#define OUTPUT 0x01
+#define INPUT_PULLUP 0x02
+#define LOW 0x0
+#define HIGH 0x1
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define pgm_read_byte(address) (*reinterpret_cast<const uint8_t *>(address))
+#define pgm_read_word(address) (*reinterpret_cast<const uint16_t *>(address))
+#define pgm_read_dword(address) (*reinterpret_cast<const uint32_t *>(address))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+
+class __FlashStringHelper;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+int analogRead(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode);
+void detachInterrupt(uint8_t interrupt);
+inline uint8_t digitalPinToInterrupt(uint8_t pin) { return pin; }
+void noInterrupts();
+void interrupts();
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh);
+long random(long max);
+long random(long min, long max);
+
+// the ESP8266 core takes these from std as well
+using std::max;
+using std::min;
+#define constrain(amount, low, high) ((amount) < (low) ? (low) : ((amount) > (high) ? (high) : (amount)))
+
+// Arduino String on top of std::string. Copies are counted so the host
+// tests can see how often a call path duplicates its text.
+class String
+{
+public:
+    String() {}
+    String(const char *text) : text(text ? text : "") {}
+    String(const char *text, unsigned int length) : text(text, length) {}
+    String(const String &other) : text(other.text) { copies++; }
+    String(String &&other) noexcept : text(std::move(other.text)) {}
+    explicit String(char c) : text(1, c) {}
+    explicit String(int value) : text(std::to_string(value)) {}
+    explicit String(unsigned int value) : text(std::to_string(value)) {}
+    explicit String(long value) : text(std::to_string(value)) {}
+    explicit String(unsigned long value) : text(std::to_string(value)) {}
+
+    String &operator=(const String &other)
+    {
+        copies++;
+        text = other.text;
+        return *this;
+    }
+    String &operator=(String &&other) noexcept
+    {
+        text = std::move(other.text);
+        return *this;
+    }
+    String &operator=(const char *other)
+    {
+        text = other ? other : "";
+        return *this;
+    }
+
+    unsigned int length() const { return text.size(); }
+    const char *c_str() const { return text.c_str(); }
+    char charAt(unsigned int index) const { return index < text.size() ? text[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    bool reserve(unsigned int size)
+    {
+        text.reserve(size);
+        return true;
+    }
+    bool isEmpty() const { return text.empty(); }
+
+    int indexOf(char c, unsigned int from = 0) const { return Position(text.find(c, from)); }
+    int indexOf(const String &other, unsigned int from = 0) const { return Position(text.find(other.text, from)); }
+    bool startsWith(const String &prefix) const { return text.compare(0, prefix.text.size(), prefix.text) == 0; }
+    bool endsWith(const String &suffix) const
+    {
+        return text.size() >= suffix.text.size() && text.compare(text.size() - suffix.text.size(), suffix.text.size(), suffix.text) == 0;
+    }
+    String substring(unsigned int from) const { return String(from < text.size() ? text.substr(from) : std::string()); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        return String(from < text.size() && to > from ? text.substr(from, to - from) : std::string());
+    }
+    long toInt() const { return atol(text.c_str()); }
+
+    bool concat(const String &other)
+    {
+        text += other.text;
+        return true;
+    }
+    bool concat(const char *other)
+    {
+        text += other;
+        return true;
+    }
+    bool concat(const char *other, unsigned int length)
+    {
+        text.append(other, length);
+        return true;
+    }
+    bool concat(char c)
+    {
+        text += c;
+        return true;
+    }
+    String &operator+=(const String &other)
+    {
+        text += other.text;
+        return *this;
+    }
+    String &operator+=(const char *other)
+    {
+        text += other;
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        text += c;
+        return *this;
+    }
+
+    bool operator==(const String &other) const { return text == other.text; }
+    bool operator==(const char *other) const { return text == other; }
+    bool operator!=(const String &other) const { return text != other.text; }
+    bool operator!=(const char *other) const { return text != other; }
+    bool equals(const String &other) const { return text == other.text; }
+
+    friend String operator+(const String &left, const String &right) { return String(left.text + right.text); }
+    friend String operator+(const String &left, const char *right) { return String(left.text + right); }
+    friend String operator+(const char *left, const String &right) { return String(left + right.text); }
+    friend String operator+(String &&left, const String &right)
+    {
+        left.text += right.text;
+        return std::move(left);
+    }
+    friend String operator+(String &&left, const char *right)
+    {
+        left.text += right;
+        return std::move(left);
+    }
+
+    // deep copies made through the copy constructor or copy assignment
+    static unsigned long copies;
+
+private:
+    std::string text;
+
+    explicit String(std::string &&other) : text(std::move(other)) {}
+    static int Position(size_t found) { return found == std::string::npos ? -1 : (int)found; }
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t written = 0;
+        while (size--)
+        {
+            written += write(*buffer++);
+        }
+        return written;
+    }
+    size_t write(const char *text) { return text ? write(reinterpret_cast<const uint8_t *>(text), strlen(text)) : 0; }
+    size_t write(const char *buffer, size_t size) { return write(reinterpret_cast<const uint8_t *>(buffer), size); }
+
+    size_t print(const __FlashStringHelper *text) { return write(reinterpret_cast<const char *>(text)); }
+    size_t print(const String &text) { return write(text.c_str(), text.length()); }
+    size_t print(const char *text) { return write(text); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = 10) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = 10) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = 10) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = 10);
+    size_t print(unsigned long value, int base = 10);
+    size_t print(double value, int digits = 2);
+
+    template <typename T>
+    size_t println(const T &value)
+    {
+        size_t written = print(value);
+        return written + println();
+    }
+    template <typename T>
+    size_t println(const T &value, int format)
+    {
+        size_t written = print(value, format);
+        return written + println();
+    }
+    size_t println() { return write("\r\n"); }
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+
+    void setTimeout(unsigned long timeout) { this->timeout = timeout; }
+    size_t readBytes(uint8_t *buffer, size_t size)
+    {
+        size_t count = 0;
+        while (count < size)
+        {
+            int c = read();
+            if (c < 0)
+            {
+                break;
+            }
+            buffer[count++] = (uint8_t)c;
+        }
+        return count;
+    }
+
+protected:
+    unsigned long timeout = 1000;
+};
+
+// Goes to stdout when Host::EchoSerial(true), otherwise nowhere
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMaxFreeBlockSize();
+    uint8_t getHeapFragmentation();
+    uint32_t getCycleCount();
+    void restart() {}
+};
+
+extern EspClass ESP;
+
+// Timer1 of the ESP8266, driven from simulated time
+#define TIM_DIV1 0
+#define TIM_DIV16 1
+#define TIM_DIV256 3
+#define TIM_EDGE 0
+#define TIM_LEVEL 1
+#define TIM_SINGLE 0
+#define TIM_LOOP 1
+typedef void (*timercallback)(void);
+void timer1_attachInterrupt(timercallback callback);
+void timer1_detachInterrupt();
+void timer1_enable(uint8_t divider, uint8_t interruptType, uint8_t reload);
+void timer1_disable();
+void timer1_write(uint32_t ticks);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Arduino.h>
+#include "WiFiClientSecure.h"
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+// The station side of the WiFi stack, connected unless a test says otherwise
+class ESP8266WiFiClass
+{
+public:
+    wl_status_t status() { return connectedStatus; }
+    bool disconnect(bool wifiOff = false)
+    {
+        disconnects++;
+        return true;
+    }
+    bool reconnect()
+    {
+        reconnects++;
+        return true;
+    }
+
+    wl_status_t connectedStatus = WL_CONNECTED;
+    unsigned long disconnects = 0;
+    unsigned long reconnects = 0;
+};
+
+extern ESP8266WiFiClass WiFi;
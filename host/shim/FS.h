@@ -0,0 +1,92 @@
+#pragma once
+
+#include <memory>
+#include <map>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+
+namespace fs
+{
+    struct Storage;
+
+    // A file of the in-memory file system, reads and writes go straight to it
+    class File : public Stream
+    {
+    public:
+        File() {}
+        File(std::shared_ptr<std::vector<uint8_t>> data, bool writable) : data(std::move(data)), writable(writable) {}
+
+        explicit operator bool() const { return data != nullptr; }
+        size_t size() const { return data ? data->size() : 0; }
+        size_t position() const { return offset; }
+        bool seek(uint32_t position)
+        {
+            offset = position;
+            return data && position <= data->size();
+        }
+        void close() { data.reset(); }
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t *buffer, size_t size) override
+        {
+            if (!data || !writable)
+            {
+                return 0;
+            }
+            data->insert(data->end(), buffer, buffer + size);
+            return size;
+        }
+        using Print::write;
+        int available() override { return data ? (int)(data->size() - offset) : 0; }
+        int read() override
+        {
+            uint8_t c;
+            return read(&c, 1) == 1 ? c : -1;
+        }
+        size_t read(uint8_t *buffer, size_t size)
+        {
+            if (!data || offset >= data->size())
+            {
+                return 0;
+            }
+            size_t count = data->size() - offset < size ? data->size() - offset : size;
+            memcpy(buffer, data->data() + offset, count);
+            offset += count;
+            return count;
+        }
+        int peek() override { return data && offset < data->size() ? (*data)[offset] : -1; }
+
+    private:
+        std::shared_ptr<std::vector<uint8_t>> data;
+        bool writable = false;
+        size_t offset = 0;
+    };
+
+    class FS
+    {
+    public:
+        bool begin() { return mounted = !failMount; }
+        void end() { mounted = false; }
+        bool format()
+        {
+            files.clear();
+            return true;
+        }
+
+        File open(const char *path, const char *mode);
+        File open(const String &path, const char *mode) { return open(path.c_str(), mode); }
+        bool exists(const char *path) const { return files.count(path) != 0; }
+        bool remove(const char *path) { return files.erase(path) != 0; }
+
+        // host only: the mount fails while set, writes are counted
+        bool failMount = false;
+        unsigned long writes = 0;
+
+    private:
+        bool mounted = false;
+        std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+    };
+}
+
+using fs::File;
@@ -0,0 +1,219 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <new>
+#include "HeapStats.h"
+
+namespace
+{
+    // umm_malloc, the ESP8266 allocator, hands out 8 byte blocks with a 4 byte header
+    const size_t BlockSize = 8;
+    const size_t BlockHeader = 4;
+    const size_t Untracked = SIZE_MAX;
+    const size_t MaxSegments = 8192;
+
+    struct Header
+    {
+        size_t size;
+        size_t offset;
+    };
+    static_assert(sizeof(Header) == 16, "keeps allocations 16 byte aligned");
+
+    struct Segment
+    {
+        size_t offset;
+        size_t size;
+    };
+
+    bool tracking = false;
+    unsigned outside = 0;
+    size_t arenaSize = 0;
+    unsigned long allocations = 0;
+    unsigned long failures = 0;
+    size_t currentBytes = 0;
+    size_t peakBytes = 0;
+    // free space of the simulated heap, sorted by offset
+    Segment segments[MaxSegments];
+    size_t segmentCount = 0;
+
+    size_t Footprint(size_t size)
+    {
+        return (size + BlockHeader + BlockSize - 1) / BlockSize * BlockSize;
+    }
+
+    size_t Place(size_t size)
+    {
+        size_t need = Footprint(size);
+        for (size_t i = 0; i < segmentCount; i++)
+        {
+            if (segments[i].size >= need)
+            {
+                size_t offset = segments[i].offset;
+                segments[i].offset += need;
+                segments[i].size -= need;
+                if (segments[i].size == 0)
+                {
+                    for (size_t j = i + 1; j < segmentCount; j++)
+                    {
+                        segments[j - 1] = segments[j];
+                    }
+                    segmentCount--;
+                }
+                return offset;
+            }
+        }
+        return Untracked;
+    }
+
+    void Release(size_t offset, size_t size)
+    {
+        size_t need = Footprint(size);
+        size_t index = 0;
+        while (index < segmentCount && segments[index].offset < offset)
+        {
+            index++;
+        }
+        bool joinsPrevious = index > 0 && segments[index - 1].offset + segments[index - 1].size == offset;
+        bool joinsNext = index < segmentCount && offset + need == segments[index].offset;
+        if (joinsPrevious && joinsNext)
+        {
+            segments[index - 1].size += need + segments[index].size;
+            for (size_t j = index + 1; j < segmentCount; j++)
+            {
+                segments[j - 1] = segments[j];
+            }
+            segmentCount--;
+        }
+        else if (joinsPrevious)
+        {
+            segments[index - 1].size += need;
+        }
+        else if (joinsNext)
+        {
+            segments[index].offset = offset;
+            segments[index].size += need;
+        }
+        else if (segmentCount < MaxSegments)
+        {
+            for (size_t j = segmentCount; j > index; j--)
+            {
+                segments[j] = segments[j - 1];
+            }
+            segments[index].offset = offset;
+            segments[index].size = need;
+            segmentCount++;
+        }
+    }
+
+    void *Allocate(size_t size)
+    {
+        Header *header = static_cast<Header *>(malloc(sizeof(Header) + (size ? size : 1)));
+        if (!header)
+        {
+            return nullptr;
+        }
+        header->size = size;
+        header->offset = Untracked;
+        if (tracking && outside == 0)
+        {
+            allocations++;
+            header->offset = Place(size);
+            if (header->offset == Untracked)
+            {
+                failures++;
+            }
+            else
+            {
+                currentBytes += size;
+                if (currentBytes > peakBytes)
+                {
+                    peakBytes = currentBytes;
+                }
+            }
+        }
+        return header + 1;
+    }
+
+    void Free(void *pointer)
+    {
+        if (!pointer)
+        {
+            return;
+        }
+        Header *header = static_cast<Header *>(pointer) - 1;
+        if (tracking && header->offset != Untracked)
+        {
+            Release(header->offset, header->size);
+            currentBytes -= header->size;
+        }
+        free(header);
+    }
+}
+
+namespace HeapStats
+{
+    void Begin(size_t arena)
+    {
+        arenaSize = arena;
+        allocations = 0;
+        failures = 0;
+        currentBytes = 0;
+        peakBytes = 0;
+        segments[0].offset = 0;
+        segments[0].size = arena;
+        segmentCount = 1;
+        tracking = true;
+    }
+
+    // allocations still alive are left to the real heap, freeing them later is harmless
+    void End() { tracking = false; }
+
+    Outside::Outside() { outside++; }
+    Outside::~Outside() { outside--; }
+
+    bool Tracking() { return tracking; }
+    unsigned long Allocations() { return allocations; }
+    size_t CurrentBytes() { return currentBytes; }
+    size_t PeakBytes() { return peakBytes; }
+    unsigned long Failures() { return failures; }
+
+    size_t FreeBytes()
+    {
+        size_t free = 0;
+        for (size_t i = 0; i < segmentCount; i++)
+        {
+            free += segments[i].size;
+        }
+        return free;
+    }
+
+    size_t LargestFreeBlock()
+    {
+        size_t largest = 0;
+        for (size_t i = 0; i < segmentCount; i++)
+        {
+            if (segments[i].size > largest)
+            {
+                largest = segments[i].size;
+            }
+        }
+        return largest > BlockHeader ? largest - BlockHeader : 0;
+    }
+}
+
+void *operator new(size_t size)
+{
+    void *pointer = Allocate(size);
+    if (!pointer)
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return Allocate(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return Allocate(size); }
+void operator delete(void *pointer) noexcept { Free(pointer); }
+void operator delete[](void *pointer) noexcept { Free(pointer); }
+void operator delete(void *pointer, size_t) noexcept { Free(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { Free(pointer); }
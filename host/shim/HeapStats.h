@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stddef.h>
+
+// Counts what goes through operator new and delete on the host build. While
+// tracking, every allocation is also placed in a simulated first-fit heap
+// of the given size, which is what makes fragmentation visible: the largest
+// free block there is what ESP.getMaxFreeBlockSize() would report.
+namespace HeapStats
+{
+    // the ESP8266 has about 50 KB of heap with WiFi up
+    const size_t DefaultArena = 50 * 1024;
+
+    void Begin(size_t arena = DefaultArena);
+    void End();
+    bool Tracking();
+
+    unsigned long Allocations();
+    size_t CurrentBytes();
+    size_t PeakBytes();
+    size_t FreeBytes();
+    size_t LargestFreeBlock();
+    // allocations that did not fit the simulated heap
+    unsigned long Failures();
+
+    // What is allocated while one of these is alive stays out of the
+    // simulated heap. The host network puts the server side in one, the
+    // mocks and their sockets are not on the ESP8266.
+    class Outside
+    {
+    public:
+        Outside();
+        ~Outside();
+    };
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+
+// Control side of the host shims. Nothing here exists on the ESP8266, the
+// tests and benchmarks use it to stand in for time, pins and interrupts.
+namespace Host
+{
+    // Simulated time. millis() and micros() read it, delay() and yield()
+    // move it forward and run whatever timers fall due on the way.
+    uint64_t Now();
+    void Advance(uint64_t micros);
+    void AdvanceMillis(unsigned long millis);
+    // The CPU held without yielding, as in a TLS handshake: the clock moves
+    // on and no timer runs. A repeating timer that fell behind fires once
+    // on the next Advance() and counts its next period from there.
+    void Stall(uint64_t micros);
+    // how far a yield() moves time, loops that wait on the network need it
+    void SetYieldMicros(uint64_t micros);
+    // puts time back to zero and forgets timers, interrupts and pins
+    void Reset();
+
+    // Timers run from Advance() in time order, like SDK timers run between
+    // loop() passes. A period of 0 fires once.
+    typedef int TimerId;
+    TimerId AddTimer(uint64_t periodMicros, std::function<void()> callback, bool repeat);
+    void RemoveTimer(TimerId id);
+
+    void SetAnalogSource(std::function<int(uint8_t pin)> source);
+    void SetDigitalPin(uint8_t pin, int value);
+    // calls the handler attached to the pin, if any
+    bool RaiseInterrupt(uint8_t pin);
+
+    void EchoSerial(bool echo);
+}
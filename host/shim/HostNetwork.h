@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+struct HostHttpRequest
+{
+    std::string method;
+    std::string path;
+    // names in lower case
+    std::map<std::string, std::string> headers;
+    std::string body;
+
+    std::string Header(const std::string &name) const
+    {
+        auto header = headers.find(name);
+        return header == headers.end() ? std::string() : header->second;
+    }
+};
+
+struct HostHttpResponse
+{
+    int status = 200;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+    bool chunked = false;
+    // the server closes the socket once this response is sent
+    bool close = false;
+    // extra time the server takes before answering
+    unsigned long delayMillis = 0;
+};
+
+// An HTTPS server on the simulated network, what WiFiClientSecure connects
+// to on the host build. Handshakes and round trips cost simulated time, so
+// a test sees what a request path costs without a real TLS stack; session
+// ids it handed out are resumed with the cheaper handshake.
+class HostServer
+{
+public:
+    virtual ~HostServer() {}
+    virtual void Handle(const HostHttpRequest &request, HostHttpResponse &response) = 0;
+
+    unsigned long fullHandshakeMillis = 400;
+    unsigned long resumedHandshakeMillis = 80;
+    unsigned long roundTripMillis = 60;
+    // 0 delivers a response in one piece, otherwise it trickles in at this rate
+    unsigned long bytesPerMilli = 0;
+    // idle sockets are closed by the server after this long
+    unsigned long keepAliveMillis = 60000;
+    bool resumption = true;
+    // a connect() fails while set
+    bool down = false;
+
+    unsigned long connections = 0;
+    unsigned long fullHandshakes = 0;
+    unsigned long resumedHandshakes = 0;
+    unsigned long requests = 0;
+    unsigned long bytesSent = 0;
+
+    void ResetCounters()
+    {
+        connections = 0;
+        fullHandshakes = 0;
+        resumedHandshakes = 0;
+        requests = 0;
+        bytesSent = 0;
+    }
+
+    // closes every open connection, as a server restart would
+    void DropConnections() { generation++; }
+    unsigned long Generation() const { return generation; }
+
+    // server side of the session cache
+    bool KnowsSession(const std::string &id) const { return sessions.count(id) != 0; }
+    void ForgetSessions() { sessions.clear(); }
+    std::string NewSession()
+    {
+        std::string id(32, '\0');
+        unsigned long serial = ++sessionSerial;
+        for (size_t i = 0; i < id.size(); i++)
+        {
+            id[i] = (char)((serial >> (8 * (i % 8))) ^ (i * 37) ^ 0x5A);
+        }
+        sessions.insert(id);
+        return id;
+    }
+
+private:
+    unsigned long generation = 0;
+    unsigned long sessionSerial = 0;
+    std::set<std::string> sessions;
+};
+
+namespace Host
+{
+    void AddServer(const char *host, HostServer *server);
+    void RemoveServers();
+}
@@ -0,0 +1,136 @@
+#include "ESP8266WiFi.h"
+#include "SPI.h"
+#include "base64.h"
+#include "LittleFS.h"
+#include "Adafruit_NeoPixel.h"
+
+ESP8266WiFiClass WiFi;
+SPIClass SPI;
+fs::FS LittleFS;
+
+String base64::encode(const uint8_t *data, size_t length)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string text;
+    for (size_t i = 0; i < length; i += 3)
+    {
+        uint32_t group = (uint32_t)data[i] << 16;
+        if (i + 1 < length)
+        {
+            group |= (uint32_t)data[i + 1] << 8;
+        }
+        if (i + 2 < length)
+        {
+            group |= data[i + 2];
+        }
+        text += alphabet[(group >> 18) & 0x3F];
+        text += alphabet[(group >> 12) & 0x3F];
+        text += i + 1 < length ? alphabet[(group >> 6) & 0x3F] : '=';
+        text += i + 2 < length ? alphabet[group & 0x3F] : '=';
+    }
+    return String(text.c_str());
+}
+
+fs::File fs::FS::open(const char *path, const char *mode)
+{
+    if (!mounted)
+    {
+        return File();
+    }
+    auto file = files.find(path);
+    if (mode[0] == 'r')
+    {
+        return file == files.end() ? File() : File(file->second, false);
+    }
+    writes++;
+    auto data = std::make_shared<std::vector<uint8_t>>();
+    if (mode[0] == 'a' && file != files.end())
+    {
+        *data = *file->second;
+    }
+    files[path] = data;
+    return File(data, true);
+}
+
+uint32_t Adafruit_NeoPixel::ColorHSV(uint16_t hue, uint8_t saturation, uint8_t value)
+{
+    uint8_t r, g, b;
+    hue = (hue * 1530L + 32768) / 65536;
+    if (hue < 510)
+    {
+        b = 0;
+        if (hue < 255)
+        {
+            r = 255;
+            g = hue;
+        }
+        else
+        {
+            r = 510 - hue;
+            g = 255;
+        }
+    }
+    else if (hue < 1020)
+    {
+        r = 0;
+        if (hue < 765)
+        {
+            g = 255;
+            b = hue - 510;
+        }
+        else
+        {
+            g = 1020 - hue;
+            b = 255;
+        }
+    }
+    else if (hue < 1530)
+    {
+        g = 0;
+        if (hue < 1275)
+        {
+            r = hue - 1020;
+            b = 255;
+        }
+        else
+        {
+            r = 255;
+            b = 1530 - hue;
+        }
+    }
+    else
+    {
+        r = 255;
+        g = b = 0;
+    }
+    uint32_t v1 = 1 + value;
+    uint16_t s1 = 1 + saturation;
+    uint8_t s2 = 255 - saturation;
+    return ((((((r * s1) >> 8) + s2) * v1) & 0xff00) << 8) | (((((g * s1) >> 8) + s2) * v1) & 0xff00) | (((((b * s1) >> 8) + s2) * v1) >> 8);
+}
+
+uint8_t Adafruit_NeoPixel::gamma8(uint8_t x)
+{
+    // the library's table is gamma 2.6
+    static uint8_t table[256];
+    static bool built = false;
+    if (!built)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            table[i] = (uint8_t)(pow(i / 255.0, 2.6) * 255 + 0.5);
+        }
+        built = true;
+    }
+    return table[x];
+}
+
+uint32_t Adafruit_NeoPixel::gamma32(uint32_t x)
+{
+    uint8_t *channels = reinterpret_cast<uint8_t *>(&x);
+    for (int i = 0; i < 4; i++)
+    {
+        channels[i] = gamma8(channels[i]);
+    }
+    return x;
+}
@@ -0,0 +1,345 @@
+#include "MFRC522.h"
+#include "Host.h"
+
+// ComIrqReg bits
+#define IRQ_SET1 0x80
+#define IRQ_RX 0x20
+#define IRQ_IDLE 0x10
+#define IRQ_TIMER 0x01
+// ComIEnReg: RxIEn
+#define IRQ_ENABLE_RX 0x20
+// BitFramingReg: StartSend
+#define START_SEND 0x80
+
+uint16_t HostCrcA(const byte *data, size_t length)
+{
+    uint16_t crc = 0x6363;
+    for (size_t i = 0; i < length; i++)
+    {
+        byte c = data[i] ^ (byte)crc;
+        c ^= c << 4;
+        crc = (crc >> 8) ^ ((uint16_t)c << 8) ^ ((uint16_t)c << 3) ^ (c >> 4);
+    }
+    return crc;
+}
+
+void MFRC522::PCD_Init()
+{
+    memset(registers, 0, sizeof(registers));
+    registers[VersionReg >> 1] = 0x92;
+    fifo.clear();
+    registerAccesses += 12;
+}
+
+void MFRC522::PCD_WriteRegister(PCD_Register reg, byte value)
+{
+    registerAccesses++;
+    writes.push_back(std::make_pair((byte)reg, value));
+    switch (reg)
+    {
+    case FIFODataReg:
+        fifo.push_back(value);
+        return;
+    case FIFOLevelReg:
+        // FlushBuffer
+        if (value & 0x80)
+        {
+            fifo.clear();
+        }
+        return;
+    case ComIrqReg:
+        if (value & IRQ_SET1)
+        {
+            registers[reg >> 1] |= value & 0x7F;
+        }
+        else
+        {
+            registers[reg >> 1] &= ~value;
+            if (!(registers[reg >> 1] & registers[ComIEnReg >> 1] & 0x7F) && irqPin >= 0)
+            {
+                Host::SetDigitalPin(irqPin, HIGH);
+            }
+        }
+        return;
+    case BitFramingReg:
+        registers[reg >> 1] = value;
+        if ((value & START_SEND) && registers[CommandReg >> 1] == PCD_Transceive)
+        {
+            StartSend();
+        }
+        return;
+    default:
+        registers[reg >> 1] = value;
+        return;
+    }
+}
+
+byte MFRC522::PCD_ReadRegister(PCD_Register reg)
+{
+    registerAccesses++;
+    switch (reg)
+    {
+    case FIFOLevelReg:
+        return fifo.size();
+    case FIFODataReg:
+    {
+        if (fifo.empty())
+        {
+            return 0;
+        }
+        byte value = fifo.front();
+        fifo.erase(fifo.begin());
+        return value;
+    }
+    default:
+        return registers[reg >> 1];
+    }
+}
+
+void MFRC522::PCD_SetRegisterBitMask(PCD_Register reg, byte mask)
+{
+    PCD_WriteRegister(reg, PCD_ReadRegister(reg) | mask);
+}
+
+void MFRC522::PCD_ClearRegisterBitMask(PCD_Register reg, byte mask)
+{
+    PCD_WriteRegister(reg, PCD_ReadRegister(reg) & ~mask);
+}
+
+MFRC522::StatusCode MFRC522::PCD_CalculateCRC(byte *data, byte length, byte *result)
+{
+    // idle, flush, the data and the command, then the result back
+    registerAccesses += 5 + length;
+    uint16_t crc = HostCrcA(data, length);
+    result[0] = crc & 0xFF;
+    result[1] = crc >> 8;
+    return STATUS_OK;
+}
+
+// A frame sent by hand through the registers, the way CardDetector leaves a
+// WUPA in flight. Whatever sits in the FIFO goes out, so a FIFO that was not
+// flushed first sends a frame no tag answers.
+void MFRC522::StartSend()
+{
+    exchanges++;
+    std::vector<byte> frame = fifo;
+    fifo.clear();
+    byte bits = registers[BitFramingReg >> 1] & 0x07;
+    bool shortFrame = bits == 7 && frame.size() == 1;
+    bool wakes = shortFrame && frame[0] == PICC_CMD_WUPA && tag && tag->state != HostTag::Active;
+    bool requests = shortFrame && frame[0] == PICC_CMD_REQA && tag && tag->state == HostTag::Idle;
+    if (!wakes && !requests)
+    {
+        // nothing answers, the reader's own timer runs out
+        return;
+    }
+    tag->state = HostTag::Ready;
+    fifo.push_back(0x44);
+    fifo.push_back(0x00);
+    RaiseRxIrq();
+}
+
+void MFRC522::RaiseRxIrq()
+{
+    registers[ComIrqReg >> 1] |= IRQ_RX | IRQ_IDLE;
+    // the pin is active low and falls when an enabled request comes up
+    if ((registers[ComIEnReg >> 1] & IRQ_ENABLE_RX) && irqPin >= 0 && digitalRead(irqPin) == HIGH)
+    {
+        Host::SetDigitalPin(irqPin, LOW);
+        Host::RaiseInterrupt(irqPin);
+    }
+}
+
+// The library flushes the FIFO and clears every request before an exchange.
+// An answer sets RxIRq again, which is why its exchanges leave the pin low.
+void MFRC522::Exchange(bool answered)
+{
+    exchanges++;
+    fifo.clear();
+    registers[ComIrqReg >> 1] = 0;
+    if (irqPin >= 0)
+    {
+        Host::SetDigitalPin(irqPin, HIGH);
+    }
+    if (answered)
+    {
+        RaiseRxIrq();
+    }
+    else
+    {
+        registers[ComIrqReg >> 1] |= IRQ_TIMER;
+    }
+}
+
+MFRC522::StatusCode MFRC522::Nak()
+{
+    // a NAK sends the tag back to IDLE, it has to be woken and selected again
+    tag->state = HostTag::Idle;
+    return STATUS_MIFARE_NACK;
+}
+
+MFRC522::StatusCode MFRC522::PCD_TransceiveData(byte *sendData, byte sendLen, byte *backData, byte *backLen, byte *validBits, byte rxAlign, bool checkCRC)
+{
+    registerAccesses += 6 + sendLen;
+    bool broken = sendLen >= 3 && HostCrcA(sendData, sendLen - 2) != (sendData[sendLen - 2] | (sendData[sendLen - 1] << 8));
+    // a tag that is not selected or gets a frame with a broken CRC stays silent
+    bool answers = tag && tag->state == HostTag::Active && !tag->unreadable && !broken;
+    Exchange(answers);
+    if (!answers)
+    {
+        return STATUS_TIMEOUT;
+    }
+
+    std::vector<byte> answer;
+    if (sendData[0] == 0x3A && sendLen == 5)
+    {
+        byte start = sendData[1];
+        byte end = sendData[2];
+        if (!tag->fastRead || start > end || end >= tag->Pages())
+        {
+            return Nak();
+        }
+        answer.assign(tag->memory.begin() + start * 4, tag->memory.begin() + (end + 1) * 4);
+    }
+    else if (sendData[0] == PICC_CMD_MF_READ && sendLen == 4)
+    {
+        byte page = sendData[1];
+        if (page >= tag->Pages())
+        {
+            return Nak();
+        }
+        // four pages, rolling over at the end of memory
+        for (int i = 0; i < 16; i++)
+        {
+            answer.push_back(tag->memory[(page * 4 + i) % tag->memory.size()]);
+        }
+    }
+    else
+    {
+        return Nak();
+    }
+
+    uint16_t crc = HostCrcA(answer.data(), answer.size());
+    answer.push_back(crc & 0xFF);
+    answer.push_back(crc >> 8);
+    // the answer has to fit the 64 byte FIFO
+    if (answer.size() > 64)
+    {
+        return STATUS_ERROR;
+    }
+    if (!backData || !backLen || answer.size() > *backLen)
+    {
+        return STATUS_NO_ROOM;
+    }
+    memcpy(backData, answer.data(), answer.size());
+    *backLen = answer.size();
+    registerAccesses += answer.size();
+    return STATUS_OK;
+}
+
+MFRC522::StatusCode MFRC522::Request(byte command, byte *bufferATQA, byte *bufferSize)
+{
+    registerAccesses += 8;
+    if (!bufferATQA || !bufferSize || *bufferSize < 2)
+    {
+        return STATUS_NO_ROOM;
+    }
+    bool answers = tag && (command == PICC_CMD_WUPA ? tag->state != HostTag::Active : tag->state == HostTag::Idle);
+    Exchange(answers);
+    if (!answers)
+    {
+        return STATUS_TIMEOUT;
+    }
+    tag->state = HostTag::Ready;
+    bufferATQA[0] = 0x44;
+    bufferATQA[1] = 0x00;
+    *bufferSize = 2;
+    return STATUS_OK;
+}
+
+bool MFRC522::PICC_IsNewCardPresent()
+{
+    byte atqa[2];
+    byte size = sizeof(atqa);
+    StatusCode result = PICC_RequestA(atqa, &size);
+    return result == STATUS_OK || result == STATUS_COLLISION;
+}
+
+MFRC522::StatusCode MFRC522::PICC_RequestA(byte *bufferATQA, byte *bufferSize)
+{
+    return Request(PICC_CMD_REQA, bufferATQA, bufferSize);
+}
+
+MFRC522::StatusCode MFRC522::PICC_WakeupA(byte *bufferATQA, byte *bufferSize)
+{
+    return Request(PICC_CMD_WUPA, bufferATQA, bufferSize);
+}
+
+MFRC522::StatusCode MFRC522::PICC_Select(Uid *uid, byte validBits)
+{
+    if (!tag || tag->state != HostTag::Ready)
+    {
+        Exchange(false);
+        return STATUS_TIMEOUT;
+    }
+    // anticollision and select for each cascade level
+    int levels = tag->uidSize <= 4 ? 1 : tag->uidSize <= 7 ? 2 : 3;
+    Exchange(true);
+    exchanges += 2 * levels - 1;
+    registerAccesses += 20 * levels;
+    tag->state = HostTag::Active;
+    uid->size = tag->uidSize;
+    memcpy(uid->uidByte, tag->uid, tag->uidSize);
+    uid->sak = 0x00;
+    return STATUS_OK;
+}
+
+MFRC522::StatusCode MFRC522::PICC_HaltA()
+{
+    registerAccesses += 8;
+    Exchange(false);
+    if (tag && tag->state == HostTag::Active)
+    {
+        tag->state = HostTag::Halted;
+    }
+    // HLTA is never answered, the library reports the timeout as success
+    return STATUS_OK;
+}
+
+MFRC522::StatusCode MFRC522::MIFARE_Read(byte blockAddr, byte *buffer, byte *bufferSize)
+{
+    if (!buffer || !bufferSize || *bufferSize < 18)
+    {
+        return STATUS_NO_ROOM;
+    }
+    byte command[4] = {PICC_CMD_MF_READ, blockAddr};
+    PCD_CalculateCRC(command, 2, &command[2]);
+    return PCD_TransceiveData(command, 4, buffer, bufferSize, nullptr, 0, true);
+}
+
+const __FlashStringHelper *MFRC522::GetStatusCodeName(StatusCode code)
+{
+    switch (code)
+    {
+    case STATUS_OK:
+        return F("Success.");
+    case STATUS_ERROR:
+        return F("Error in communication.");
+    case STATUS_COLLISION:
+        return F("Collission detected.");
+    case STATUS_TIMEOUT:
+        return F("Timeout in communication.");
+    case STATUS_NO_ROOM:
+        return F("A buffer is not big enough.");
+    case STATUS_INTERNAL_ERROR:
+        return F("Internal error in the code. Should not happen.");
+    case STATUS_INVALID:
+        return F("Invalid argument.");
+    case STATUS_CRC_WRONG:
+        return F("The CRC_A does not match.");
+    case STATUS_MIFARE_NACK:
+        return F("A MIFARE PICC responded with NAK.");
+    default:
+        return F("Unknown error");
+    }
+}
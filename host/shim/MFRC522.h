@@ -0,0 +1,151 @@
+#pragma once
+
+#include <vector>
+#include <Arduino.h>
+
+// A type 2 tag (NTAG21x or Ultralight) in the simulated reader's field
+struct HostTag
+{
+    enum State : uint8_t
+    {
+        Idle,
+        Ready,
+        Active,
+        Halted
+    };
+
+    uint8_t uid[10] = {0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+    uint8_t uidSize = 7;
+    // whole tag memory, four bytes a page
+    std::vector<uint8_t> memory;
+    // NTAG21x answer FAST_READ, Ultralight NAKs it
+    bool fastRead = true;
+    // selects fine but reads time out, like a card at the edge of the field
+    bool unreadable = false;
+    State state = Idle;
+
+    uint16_t Pages() const { return memory.size() / 4; }
+};
+
+// MFRC522 reader with one simulated tag. The PICC commands follow the
+// library, the registers the sketch drives by hand are modelled as far as
+// CardDetector needs: the FIFO, the command, the IRQ bits and the IRQ pin.
+class MFRC522
+{
+public:
+    enum PCD_Register : byte
+    {
+        CommandReg = 0x01 << 1,
+        ComIEnReg = 0x02 << 1,
+        DivIEnReg = 0x03 << 1,
+        ComIrqReg = 0x04 << 1,
+        DivIrqReg = 0x05 << 1,
+        ErrorReg = 0x06 << 1,
+        Status1Reg = 0x07 << 1,
+        Status2Reg = 0x08 << 1,
+        FIFODataReg = 0x09 << 1,
+        FIFOLevelReg = 0x0A << 1,
+        ControlReg = 0x0C << 1,
+        BitFramingReg = 0x0D << 1,
+        CollReg = 0x0E << 1,
+        ModeReg = 0x11 << 1,
+        TxControlReg = 0x14 << 1,
+        TxASKReg = 0x15 << 1,
+        CRCResultRegH = 0x21 << 1,
+        CRCResultRegL = 0x22 << 1,
+        TModeReg = 0x2A << 1,
+        TPrescalerReg = 0x2B << 1,
+        TReloadRegH = 0x2C << 1,
+        TReloadRegL = 0x2D << 1,
+        VersionReg = 0x37 << 1
+    };
+
+    enum PCD_Command : byte
+    {
+        PCD_Idle = 0x00,
+        PCD_Mem = 0x01,
+        PCD_CalcCRC = 0x03,
+        PCD_Transmit = 0x04,
+        PCD_Receive = 0x08,
+        PCD_Transceive = 0x0C,
+        PCD_MFAuthent = 0x0E,
+        PCD_SoftReset = 0x0F
+    };
+
+    enum PICC_Command : byte
+    {
+        PICC_CMD_REQA = 0x26,
+        PICC_CMD_WUPA = 0x52,
+        PICC_CMD_HLTA = 0x50,
+        PICC_CMD_MF_READ = 0x30
+    };
+
+    enum StatusCode : byte
+    {
+        STATUS_OK,
+        STATUS_ERROR,
+        STATUS_COLLISION,
+        STATUS_TIMEOUT,
+        STATUS_NO_ROOM,
+        STATUS_INTERNAL_ERROR,
+        STATUS_INVALID,
+        STATUS_CRC_WRONG,
+        STATUS_MIFARE_NACK = 0xff
+    };
+
+    typedef struct
+    {
+        byte size;
+        byte uidByte[10];
+        byte sak;
+    } Uid;
+
+    Uid uid;
+
+    MFRC522(byte chipSelectPin, byte resetPowerDownPin) { memset(&uid, 0, sizeof(uid)); }
+
+    void PCD_Init();
+    void PCD_WriteRegister(PCD_Register reg, byte value);
+    byte PCD_ReadRegister(PCD_Register reg);
+    void PCD_SetRegisterBitMask(PCD_Register reg, byte mask);
+    void PCD_ClearRegisterBitMask(PCD_Register reg, byte mask);
+    StatusCode PCD_CalculateCRC(byte *data, byte length, byte *result);
+    StatusCode PCD_TransceiveData(byte *sendData, byte sendLen, byte *backData, byte *backLen, byte *validBits = nullptr, byte rxAlign = 0, bool checkCRC = false);
+    void PCD_StopCrypto1() { PCD_ClearRegisterBitMask(Status2Reg, 0x08); }
+    void PCD_SoftPowerDown() {}
+    void PCD_SoftPowerUp() {}
+
+    bool PICC_IsNewCardPresent();
+    bool PICC_ReadCardSerial() { return PICC_Select(&uid) == STATUS_OK; }
+    StatusCode PICC_RequestA(byte *bufferATQA, byte *bufferSize);
+    StatusCode PICC_WakeupA(byte *bufferATQA, byte *bufferSize);
+    StatusCode PICC_Select(Uid *uid, byte validBits = 0);
+    StatusCode PICC_HaltA();
+    StatusCode MIFARE_Read(byte blockAddr, byte *buffer, byte *bufferSize);
+
+    static const __FlashStringHelper *GetStatusCodeName(StatusCode code);
+
+    // host only
+    HostTag *tag = nullptr;
+    // pin the IRQ output is wired to, -1 when it is not
+    int8_t irqPin = -1;
+    // frames exchanged with the tag and register accesses over SPI
+    unsigned long exchanges = 0;
+    unsigned long registerAccesses = 0;
+    // every register write, in order
+    std::vector<std::pair<byte, byte>> writes;
+    // bytes left in the FIFO, as an aborted exchange leaves them
+    std::vector<byte> fifo;
+
+private:
+    byte registers[0x40] = {};
+
+    StatusCode Request(byte command, byte *bufferATQA, byte *bufferSize);
+    StatusCode Nak();
+    void StartSend();
+    void RaiseRxIrq();
+    void Exchange(bool answered);
+};
+
+// CRC_A of ISO/IEC 14443-3, what the reader's coprocessor computes
+uint16_t HostCrcA(const byte *data, size_t length);
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <vector>
+#include <Arduino.h>
+
+struct RgbColor
+{
+    RgbColor(uint8_t brightness = 0) : R(brightness), G(brightness), B(brightness) {}
+    RgbColor(uint8_t r, uint8_t g, uint8_t b) : R(r), G(g), B(b) {}
+    uint8_t R;
+    uint8_t G;
+    uint8_t B;
+};
+
+class NeoGrbFeature
+{
+};
+
+// How the methods turn the GRB bytes into what their peripheral sends,
+// two data bits at a time from a four entry table, four bytes out for
+// every byte in. waitsForWire tells whether Show() feeds the peripheral
+// itself until the frame is handed over, which the host cannot time.
+inline void EncodeTwoBits(const uint8_t *data, size_t size, const uint8_t *table, uint8_t *out)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        uint8_t value = data[i];
+        *out++ = table[value >> 6];
+        *out++ = table[(value >> 4) & 3];
+        *out++ = table[(value >> 2) & 3];
+        *out++ = table[value & 3];
+    }
+}
+
+// I2S at 3.2 MHz, a data bit is four I2S bits, 1000 or 1110
+class NeoEsp8266Dma800KbpsMethod
+{
+public:
+    static const bool waitsForWire = false;
+    static void Encode(const uint8_t *data, size_t size, uint8_t *out)
+    {
+        static const uint8_t table[4] = {0x88, 0x8E, 0xE8, 0xEE};
+        EncodeTwoBits(data, size, table, out);
+    }
+};
+
+// UART1 at 3.2 Mbaud inverted with six data bits, start and stop bits are
+// part of the pattern
+class NeoEsp8266Uart1800KbpsMethod
+{
+public:
+    // refills the 128 byte FIFO until the last of the frame has gone in
+    static const bool waitsForWire = true;
+    static void Encode(const uint8_t *data, size_t size, uint8_t *out)
+    {
+        static const uint8_t table[4] = {0b110111, 0b000111, 0b110100, 0b000100};
+        EncodeTwoBits(data, size, table, out);
+    }
+};
+
+// the same, the FIFO refilled from its empty interrupt
+class NeoEsp8266AsyncUart1800KbpsMethod : public NeoEsp8266Uart1800KbpsMethod
+{
+public:
+    static const bool waitsForWire = false;
+};
+
+// Frames go into a buffer and Show() encodes them for the method, as the
+// DMA and UART methods do before they send
+template <typename Feature, typename Method>
+class NeoPixelBus
+{
+public:
+    NeoPixelBus(uint16_t count, uint8_t pin = 3) : pixels(count), data(count * 3), wire(count * 3 * 4) {}
+
+    void Begin() {}
+    void Show()
+    {
+        for (size_t i = 0; i < pixels.size(); i++)
+        {
+            data[i * 3] = pixels[i].G;
+            data[i * 3 + 1] = pixels[i].R;
+            data[i * 3 + 2] = pixels[i].B;
+        }
+        Method::Encode(data.data(), data.size(), wire.data());
+        shows++;
+    }
+    bool CanShow() const { return true; }
+    uint16_t PixelCount() const { return pixels.size(); }
+    void SetPixelColor(uint16_t index, RgbColor color)
+    {
+        if (index < pixels.size())
+        {
+            pixels[index] = color;
+        }
+    }
+    RgbColor GetPixelColor(uint16_t index) const { return index < pixels.size() ? pixels[index] : RgbColor(0); }
+    void ClearTo(RgbColor color)
+    {
+        for (RgbColor &pixel : pixels)
+        {
+            pixel = color;
+        }
+    }
+
+    // host only
+    unsigned long shows = 0;
+    // what the last Show() handed to the peripheral
+    const std::vector<uint8_t> &Wire() const { return wire; }
+
+private:
+    std::vector<RgbColor> pixels;
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> wire;
+};
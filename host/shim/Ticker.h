@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Host.h"
+
+// The core's Ticker runs its callback from an SDK timer, the host runs it
+// from a host timer: between loop() passes and inside delay() and yield()
+class Ticker
+{
+public:
+    typedef std::function<void()> callback_function_t;
+
+    ~Ticker() { detach(); }
+
+    void attach_ms(uint32_t milliseconds, callback_function_t callback)
+    {
+        detach();
+        timer = Host::AddTimer((uint64_t)milliseconds * 1000, callback, true);
+    }
+
+    void detach()
+    {
+        if (timer)
+        {
+            Host::RemoveTimer(timer);
+            timer = 0;
+        }
+    }
+
+    bool active() const { return timer != 0; }
+
+private:
+    Host::TimerId timer = 0;
+};
@@ -0,0 +1,356 @@
+#include <deque>
+#include <stdio.h>
+#include "WiFiClientSecure.h"
+#include "HostNetwork.h"
+#include "Host.h"
+#include "HeapStats.h"
+
+struct HostResponseBytes
+{
+    uint64_t readyAt;
+    std::string bytes;
+    size_t sent;
+    bool close;
+};
+
+struct HostConnection
+{
+    HostServer *server;
+    unsigned long generation;
+    bool open;
+    uint64_t lastActivity;
+    std::string inbound;
+    std::deque<HostResponseBytes> outbound;
+};
+
+namespace
+{
+    std::map<std::string, HostServer *> servers;
+
+    std::string Lower(std::string text)
+    {
+        for (char &c : text)
+        {
+            c = tolower(c);
+        }
+        return text;
+    }
+
+    const char *Reason(int status)
+    {
+        switch (status)
+        {
+        case 200:
+            return "OK";
+        case 204:
+            return "No Content";
+        case 304:
+            return "Not Modified";
+        case 400:
+            return "Bad Request";
+        case 401:
+            return "Unauthorized";
+        case 404:
+            return "Not Found";
+        case 429:
+            return "Too Many Requests";
+        default:
+            return "Status";
+        }
+    }
+
+    std::string Serialize(const HostHttpResponse &response)
+    {
+        std::string text = "HTTP/1.1 " + std::to_string(response.status) + " " + Reason(response.status) + "\r\n";
+        for (const auto &header : response.headers)
+        {
+            text += header.first + ": " + header.second + "\r\n";
+        }
+        bool bodiless = response.status == 204 || response.status == 304;
+        if (!bodiless)
+        {
+            if (response.chunked)
+            {
+                text += "Transfer-Encoding: chunked\r\n";
+            }
+            else
+            {
+                text += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+            }
+        }
+        if (response.close)
+        {
+            text += "Connection: close\r\n";
+        }
+        text += "\r\n";
+        if (bodiless)
+        {
+            return text;
+        }
+        if (!response.chunked)
+        {
+            return text + response.body;
+        }
+        // chunks of at most 100 bytes, then the terminating one
+        for (size_t offset = 0; offset < response.body.size(); offset += 100)
+        {
+            std::string chunk = response.body.substr(offset, 100);
+            char size[16];
+            snprintf(size, sizeof(size), "%zx\r\n", chunk.size());
+            text += size + chunk + "\r\n";
+        }
+        return text + "0\r\n\r\n";
+    }
+
+    // the server went away, timed out an idle socket or was restarted
+    void CheckServerSide(HostConnection &connection)
+    {
+        if (!connection.open)
+        {
+            return;
+        }
+        HostServer &server = *connection.server;
+        bool idle = connection.outbound.empty() && connection.inbound.empty();
+        if (connection.generation != server.Generation() ||
+            (idle && Host::Now() - connection.lastActivity > (uint64_t)server.keepAliveMillis * 1000))
+        {
+            connection.open = false;
+            connection.outbound.clear();
+        }
+    }
+
+    size_t Ready(const HostConnection &connection)
+    {
+        if (connection.outbound.empty())
+        {
+            return 0;
+        }
+        const HostResponseBytes &response = connection.outbound.front();
+        if (Host::Now() < response.readyAt)
+        {
+            return 0;
+        }
+        size_t left = response.bytes.size() - response.sent;
+        if (connection.server->bytesPerMilli == 0)
+        {
+            return left;
+        }
+        uint64_t arrived = (Host::Now() - response.readyAt) * connection.server->bytesPerMilli / 1000 + 1;
+        return arrived > response.sent ? (arrived - response.sent < left ? arrived - response.sent : left) : 0;
+    }
+
+    // turns every complete request in inbound into a scheduled response
+    void Serve(HostConnection &connection)
+    {
+        HostServer &server = *connection.server;
+        while (true)
+        {
+            size_t end = connection.inbound.find("\r\n\r\n");
+            if (end == std::string::npos)
+            {
+                return;
+            }
+            HostHttpRequest request;
+            size_t lineEnd = connection.inbound.find("\r\n");
+            std::string line = connection.inbound.substr(0, lineEnd);
+            size_t space = line.find(' ');
+            request.method = line.substr(0, space);
+            request.path = line.substr(space + 1, line.rfind(' ') - space - 1);
+            size_t position = lineEnd + 2;
+            while (position < end)
+            {
+                size_t next = connection.inbound.find("\r\n", position);
+                std::string header = connection.inbound.substr(position, next - position);
+                size_t colon = header.find(':');
+                std::string value = header.substr(colon + 1);
+                value.erase(0, value.find_first_not_of(' '));
+                request.headers[Lower(header.substr(0, colon))] = value;
+                position = next + 2;
+            }
+            size_t length = atol(request.Header("content-length").c_str());
+            if (connection.inbound.size() < end + 4 + length)
+            {
+                return;
+            }
+            request.body = connection.inbound.substr(end + 4, length);
+            connection.inbound.erase(0, end + 4 + length);
+
+            HostHttpResponse response;
+            server.requests++;
+            server.Handle(request, response);
+            HostResponseBytes bytes;
+            // pipelined responses queue up behind each other
+            uint64_t earliest = connection.outbound.empty() ? 0 : connection.outbound.back().readyAt;
+            bytes.readyAt = Host::Now() + ((uint64_t)server.roundTripMillis + response.delayMillis) * 1000;
+            if (bytes.readyAt < earliest)
+            {
+                bytes.readyAt = earliest;
+            }
+            bytes.bytes = Serialize(response);
+            bytes.sent = 0;
+            bytes.close = response.close || Lower(request.Header("connection")) == "close";
+            server.bytesSent += bytes.bytes.size();
+            connection.outbound.push_back(std::move(bytes));
+        }
+    }
+}
+
+namespace Host
+{
+    void AddServer(const char *host, HostServer *server) { servers[host] = server; }
+    void RemoveServers() { servers.clear(); }
+}
+
+WiFiClient::WiFiClient() {}
+
+WiFiClient::~WiFiClient() {}
+
+// the socket and everything the server does stay out of the tracked heap
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+    HeapStats::Outside outside;
+    auto server = servers.find(host);
+    if (server == servers.end() || server->second->down)
+    {
+        connection.reset();
+        return 0;
+    }
+    connection = std::make_shared<HostConnection>();
+    connection->server = server->second;
+    connection->generation = server->second->Generation();
+    connection->open = true;
+    connection->lastActivity = Host::Now();
+    server->second->connections++;
+    return 1;
+}
+
+uint8_t WiFiClient::connected()
+{
+    if (!connection)
+    {
+        return 0;
+    }
+    CheckServerSide(*connection);
+    // like lwIP, data that already arrived can still be read after a close
+    return connection->open || Ready(*connection) > 0;
+}
+
+void WiFiClient::stop()
+{
+    if (connection)
+    {
+        connection->open = false;
+        connection->outbound.clear();
+        connection.reset();
+    }
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size)
+{
+    HeapStats::Outside outside;
+    if (!connection)
+    {
+        return 0;
+    }
+    CheckServerSide(*connection);
+    if (!connection->open)
+    {
+        return 0;
+    }
+    connection->inbound.append(reinterpret_cast<const char *>(buffer), size);
+    connection->lastActivity = Host::Now();
+    Serve(*connection);
+    return size;
+}
+
+int WiFiClient::available()
+{
+    if (!connection)
+    {
+        return 0;
+    }
+    CheckServerSide(*connection);
+    return (int)Ready(*connection);
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size)
+{
+    if (!connection)
+    {
+        return -1;
+    }
+    size_t ready = Ready(*connection);
+    if (ready == 0)
+    {
+        return -1;
+    }
+    size_t count = size < ready ? size : ready;
+    HostResponseBytes &response = connection->outbound.front();
+    memcpy(buffer, response.bytes.data() + response.sent, count);
+    response.sent += count;
+    connection->lastActivity = Host::Now();
+    if (response.sent == response.bytes.size())
+    {
+        bool close = response.close;
+        connection->outbound.pop_front();
+        if (close)
+        {
+            connection->open = false;
+            connection->outbound.clear();
+        }
+    }
+    return (int)count;
+}
+
+int WiFiClient::read()
+{
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::peek()
+{
+    if (!connection || Ready(*connection) == 0)
+    {
+        return -1;
+    }
+    const HostResponseBytes &response = connection->outbound.front();
+    return (uint8_t)response.bytes[response.sent];
+}
+
+// The handshake holds the CPU like BearSSL's does, no timer runs during it.
+// A session id the server handed out before gets the abbreviated handshake
+// and is kept; anything else costs the full one and the server's new id is
+// written back into the session.
+int BearSSL::WiFiClientSecure::connect(const char *host, uint16_t port)
+{
+    HeapStats::Outside outside;
+    if (!WiFiClient::connect(host, port))
+    {
+        return 0;
+    }
+    HostServer &server = *connection->server;
+    br_ssl_session_parameters *parameters = session ? session->getSession() : nullptr;
+    std::string offered = parameters ? std::string(reinterpret_cast<const char *>(parameters->session_id), parameters->session_id_len) : std::string();
+    if (server.resumption && !offered.empty() && server.KnowsSession(offered))
+    {
+        server.resumedHandshakes++;
+        Host::Stall((uint64_t)server.resumedHandshakeMillis * 1000);
+    }
+    else
+    {
+        server.fullHandshakes++;
+        Host::Stall((uint64_t)server.fullHandshakeMillis * 1000);
+        if (parameters)
+        {
+            std::string id = server.NewSession();
+            memcpy(parameters->session_id, id.data(), id.size());
+            parameters->session_id_len = id.size();
+            parameters->version = 0x0303;
+            parameters->cipher_suite = 0xC02F;
+            memset(parameters->master_secret, (uint8_t)id[0], sizeof(parameters->master_secret));
+        }
+    }
+    connection->lastActivity = Host::Now();
+    return 1;
+}
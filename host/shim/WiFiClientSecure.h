@@ -0,0 +1,68 @@
+#pragma once
+
+#include <memory>
+#include <Arduino.h>
+
+// BearSSL keeps the resumable part of a session in this struct
+struct br_ssl_session_parameters
+{
+    uint8_t session_id[32];
+    uint8_t session_id_len;
+    uint16_t version;
+    uint16_t cipher_suite;
+    uint8_t master_secret[48];
+};
+
+struct HostConnection;
+
+class WiFiClient : public Stream
+{
+public:
+    WiFiClient();
+    virtual ~WiFiClient();
+
+    virtual int connect(const char *host, uint16_t port);
+    int connect(const String &host, uint16_t port) { return connect(host.c_str(), port); }
+    virtual uint8_t connected();
+    virtual void stop();
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size);
+    int peek() override;
+    void setNoDelay(bool noDelay) {}
+
+protected:
+    std::shared_ptr<HostConnection> connection;
+};
+
+namespace BearSSL
+{
+    class Session
+    {
+    public:
+        Session() { memset(&_session, 0, sizeof(_session)); }
+        br_ssl_session_parameters *getSession() { return &_session; }
+
+    private:
+        br_ssl_session_parameters _session;
+    };
+
+    class WiFiClientSecure : public WiFiClient
+    {
+    public:
+        void setInsecure() {}
+        void setSession(Session *session) { this->session = session; }
+        bool setBufferSizes(int receive, int transmit) { return true; }
+        int connect(const char *host, uint16_t port) override;
+        using WiFiClient::connect;
+
+    private:
+        Session *session = nullptr;
+    };
+}
+
+using BearSSL::WiFiClientSecure;
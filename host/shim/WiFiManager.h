@@ -0,0 +1,10 @@
+#pragma once
+
+#include <ESP8266WiFi.h>
+
+class WiFiManager
+{
+public:
+    void setClass(const String &name) {}
+    bool autoConnect(const char *name, const char *password) { return WiFi.status() == WL_CONNECTED; }
+};
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "Sketch.h"
+#include "TagDump.h"
+
+namespace
+{
+    class StdoutPrint : public Print
+    {
+    public:
+        size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+    };
+
+    TaskId FindTask(const char *name)
+    {
+        for (TaskId id = 0; id < SCHEDULER_MAX_TASKS; id++)
+        {
+            const Task *task = scheduler.GetTask(id);
+            if (task->active && strcmp(task->name, name) == 0)
+            {
+                return id;
+            }
+        }
+        return -1;
+    }
+}
+
+// One stats window of the sketch with a card tapped in it: how late each task
+// started against its due time, what the tap's reads and requests cost the rest
+TEST(Jitter, ReportsLatenessPerTask)
+{
+    BootSketch();
+    int tasks = 0;
+    for (TaskId id = 0; id < SCHEDULER_MAX_TASKS; id++)
+    {
+        tasks += scheduler.GetTask(id)->active;
+    }
+    EXPECT_EQ(8, tasks);
+    ASSERT_LT(tasks, SCHEDULER_MAX_TASKS);
+
+    // start right after the stats task reset the numbers
+    TaskId stats = FindTask("stats");
+    ASSERT_GE(stats, 0);
+    unsigned long due = scheduler.GetTask(stats)->due;
+    while (scheduler.GetTask(stats)->due == due)
+    {
+        RunSketch(1);
+    }
+
+    HostTag tag = MakeTag(Ntag213, "https://open.spotify.com/album/1ay9Z4R5ZYI2TY7WiDhNYQ");
+    tag.uid[6] = 0x05;
+    unsigned long plays = sketchApi.plays;
+    RunSketch(2000);
+    // the keep-alive ran out, the tap pays for a new handshake
+    sketchApi.DropConnections();
+    mfrc522.tag = &tag;
+    RunSketch(1500);
+    mfrc522.tag = nullptr;
+    RunSketch(scheduler.GetTask(stats)->period - 4000);
+    ASSERT_EQ(plays + 1, sketchApi.plays);
+
+    StdoutPrint out;
+    scheduler.PrintStats(out);
+    const TaskStats &sound = scheduler.GetTask(FindTask("sound"))->stats;
+    const TaskStats &animation = scheduler.GetTask(FindTask("animation"))->stats;
+    const TaskStats &requests = scheduler.GetTask(FindTask("spotify"))->stats;
+    RecordProperty("sound_max_late_ms", (int)sound.maxLateness);
+    RecordProperty("animation_max_late_ms", (int)animation.maxLateness);
+    // the resumed handshake is the one call that blocks, everything else
+    // runs on time and catches up with it
+    EXPECT_EQ(1u, requests.overruns);
+    EXPECT_GE(requests.maxMicros, sketchApi.resumedHandshakeMillis * 1000);
+    EXPECT_GT(sound.maxLateness, 0u);
+    EXPECT_LE(sound.maxLateness, sketchApi.resumedHandshakeMillis);
+    EXPECT_LE(animation.maxLateness, sketchApi.resumedHandshakeMillis);
+    EXPECT_EQ(0u, sound.totalLateness / sound.runs);
+}
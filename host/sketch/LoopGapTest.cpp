@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "Sketch.h"
+#include "Host.h"
+#include "TagDump.h"
+
+// Like RunSketch(), until the tap has been played or limit ms have passed,
+// and returns the longest time between the start of two loop() passes
+static unsigned long WorstLoopGap(unsigned long plays, unsigned long limit)
+{
+    uint64_t end = Host::Now() + (uint64_t)limit * 1000;
+    uint64_t last = Host::Now();
+    uint64_t worst = 0;
+    while (Host::Now() < end && (sketchApi.plays == plays || !spotify.Idle()))
+    {
+        uint64_t before = Host::Now();
+        if (before - last > worst)
+        {
+            worst = before - last;
+        }
+        last = before;
+        loop();
+        if (Host::Now() == before)
+        {
+            Host::Advance(50);
+        }
+    }
+    return (unsigned long)(worst / 1000);
+}
+
+// api.spotify.com taking seconds to answer, a byte a millisecond. The sketch
+// lives on for the next test: the server is put back and the card taken off
+// for good.
+class LoopGap : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        BootSketch();
+        // a poll first, so a connection to the API is open when the card comes
+        RunSketch(500);
+        roundTripMillis = sketchApi.roundTripMillis;
+        sketchApi.roundTripMillis = 1500;
+        sketchApi.bytesPerMilli = 1;
+    }
+
+    void TearDown() override
+    {
+        sketchApi.roundTripMillis = roundTripMillis;
+        sketchApi.bytesPerMilli = 0;
+        mfrc522.tag = nullptr;
+        RunSketch(1000);
+    }
+
+private:
+    unsigned long roundTripMillis = 0;
+};
+
+TEST_F(LoopGap, SlowServerDoesNotStallTheLoop)
+{
+
+    HostTag tag = MakeTag(Ntag213, "https://open.spotify.com/album/1ay9Z4R5ZYI2TY7WiDhNYQ");
+    mfrc522.tag = &tag;
+    unsigned long plays = sketchApi.plays;
+    unsigned long start = millis();
+    unsigned long gap = WorstLoopGap(plays, 30000);
+    unsigned long took = millis() - start;
+
+    ASSERT_EQ(plays + 1, sketchApi.plays);
+    printf("tap to play %lu ms, worst gap between loop() passes %lu ms\n", took, gap);
+    RecordProperty("tap_ms", (int)took);
+    RecordProperty("worst_gap_ms", (int)gap);
+    EXPECT_GE(took, sketchApi.roundTripMillis);
+    // LEDs and the reader keep their 35 ms cadence
+    EXPECT_LT(gap, 35u);
+}
+
+TEST_F(LoopGap, OnlyTheHandshakeBlocks)
+{
+    // the tap has to connect again, BearSSL's handshake is the one thing that blocks
+    sketchApi.DropConnections();
+
+    HostTag tag = MakeTag(Ntag213, "https://open.spotify.com/album/1ay9Z4R5ZYI2TY7WiDhNYQ");
+    mfrc522.tag = &tag;
+    unsigned long plays = sketchApi.plays;
+    unsigned long gap = WorstLoopGap(plays, 30000);
+
+    ASSERT_EQ(plays + 1, sketchApi.plays);
+    printf("worst gap with a resumed handshake %lu ms\n", gap);
+    RecordProperty("worst_gap_ms", (int)gap);
+    EXPECT_GE(gap, sketchApi.resumedHandshakeMillis);
+    EXPECT_LT(gap, sketchApi.resumedHandshakeMillis + 35);
+}
@@ -0,0 +1,40 @@
+// The Arduino builder adds prototypes for the sketch's functions ahead of
+// it, Sketch.h declares the same ones
+#include "Sketch.h"
+#include "../../ESP8266_spotify_player.ino"
+
+#include "Host.h"
+
+MockAccounts sketchAccounts;
+MockApi sketchApi;
+
+void BootSketch()
+{
+    static bool booted = false;
+    if (booted)
+    {
+        return;
+    }
+    booted = true;
+    Host::AddServer(SPOTIFY_ACCOUNTS_HOST, &sketchAccounts);
+    Host::AddServer(SPOTIFY_API_HOST, &sketchApi);
+    // a blocking wait in setup() gets through the network one yield() at a time
+    Host::SetYieldMicros(100);
+    mfrc522.irqPin = IRQ_PIN;
+    setup();
+}
+
+void RunSketch(unsigned long millis)
+{
+    uint64_t end = Host::Now() + (uint64_t)millis * 1000;
+    while (Host::Now() < end)
+    {
+        uint64_t before = Host::Now();
+        loop();
+        // a pass that did no waiting of its own still takes a little time
+        if (Host::Now() == before)
+        {
+            Host::Advance(50);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+// The sketch's functions and the globals tests and benchmarks drive. The
+// sketch is compiled as it is, with the default LED backend.
+
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+#include "MFRC522.h"
+#include "Animator.h"
+#include "AudioSampler.h"
+#include "BeatDetector.h"
+#include "CardDetector.h"
+#include "LedRenderer.h"
+#include "NfcReader.h"
+#include "PlaybackPoller.h"
+#include "Scheduler.h"
+#include "SoundReactive.h"
+#include "Spectrum.h"
+#include "SpotifyClient.h"
+#include "TagCache.h"
+#include "TagPresence.h"
+
+void setup();
+void loop();
+void checkWifi();
+void updateSound();
+void updatePlayer();
+void pollCard();
+void handleCard(bool seen);
+void reportStats();
+bool Read();
+void drawNow();
+void connectWifi();
+String parseNFCTagData(const byte *dataBuffer, size_t size);
+
+extern Adafruit_NeoPixel pixels;
+extern LedRenderer renderer;
+extern Animator animator;
+extern AudioSampler audioSampler;
+extern Spectrum spectrum;
+extern BeatDetector beatDetector;
+extern MFRC522 mfrc522;
+extern CardDetector cardDetector;
+extern NfcReader nfc;
+extern TagCache tagCache;
+extern TagPresence tagPresence;
+extern Scheduler scheduler;
+extern SpotifyClient spotify;
+extern PlaybackPoller player;
+
+#include "MockSpotify.h"
+
+// Servers the sketch talks to on the host, registered by BootSketch()
+extern MockAccounts sketchAccounts;
+extern MockApi sketchApi;
+
+// Runs setup() once per process against the mock servers, later calls do
+// nothing. The reader's IRQ output is wired to IRQ_PIN.
+void BootSketch();
+// Calls loop() until millis simulated milliseconds have passed
+void RunSketch(unsigned long millis);
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "Sketch.h"
+#include "Host.h"
+#include "TagDump.h"
+
+TEST(Sketch, BootsAndPlaysATappedCard)
+{
+    BootSketch();
+    EXPECT_TRUE(spotify.HasToken());
+    EXPECT_TRUE(spotify.HasDevice());
+
+    HostTag tag = MakeTag(Ntag213, "https://open.spotify.com/album/1ay9Z4R5ZYI2TY7WiDhNYQ?si=a1b2c3");
+    mfrc522.tag = &tag;
+    unsigned long plays = sketchApi.plays;
+    RunSketch(3000);
+    mfrc522.tag = nullptr;
+    RunSketch(1000);
+
+    ASSERT_EQ(plays + 1, sketchApi.plays);
+    EXPECT_EQ("spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ", sketchApi.playedUris.back());
+    EXPECT_TRUE(sketchApi.playing);
+}
+
+// on and off the reader, as long as a tap takes
+static void TapCard(HostTag &tag)
+{
+    mfrc522.tag = &tag;
+    RunSketch(1500);
+    mfrc522.tag = nullptr;
+    RunSketch(500);
+}
+
+TEST(Sketch, CountsEveryTagCacheLookup)
+{
+    BootSketch();
+    HostTag album = MakeTag(Ntag213, "https://open.spotify.com/album/1ay9Z4R5ZYI2TY7WiDhNYQ");
+    album.uid[6] = 0x01;
+    HostTag blank = MakeTag(Ntag213, "https://example.com/");
+    blank.uid[6] = 0x02;
+    unsigned long hits = tagCache.GetHits();
+    unsigned long misses = tagCache.GetMisses();
+
+    TapCard(album);
+    TapCard(album);
+    // nothing on Spotify, never stored but still looked up
+    TapCard(blank);
+    TapCard(blank);
+    // rewritten with another link
+    HostTag rewritten = MakeTag(Ntag213, "https://open.spotify.com/playlist/37i9dQZF1DXcBWIGoYBM5M");
+    memcpy(rewritten.uid, album.uid, sizeof(album.uid));
+    TapCard(rewritten);
+    TapCard(rewritten);
+
+    EXPECT_EQ(2u, tagCache.GetHits() - hits);
+    EXPECT_EQ(4u, tagCache.GetMisses() - misses);
+    EXPECT_EQ("spotify:playlist:37i9dQZF1DXcBWIGoYBM5M", sketchApi.playedUris.back());
+}
+
+TEST(Sketch, RereadsOnlyCardsThatFailedToRead)
+{
+    BootSketch();
+    std::vector<uint8_t> empty;
+    HostTag blank = MakeTag(Ntag213, empty);
+    blank.uid[6] = 0x03;
+    blank.memory[16] = TLV_TERMINATOR;
+
+    // a card without a message is read once and left alone while it stays
+    mfrc522.tag = &blank;
+    RunSketch(300);
+    unsigned long transactions = nfc.GetTotalTransactions();
+    RunSketch(1000);
+    EXPECT_EQ(transactions, nfc.GetTotalTransactions());
+    mfrc522.tag = nullptr;
+    RunSketch(500);
+
+    // one that cannot be read is tried again on the next polls until it can
+    HostTag album = MakeTag(Ntag213, "https://open.spotify.com/album/6dVIqQ8qmQ5GBnJ9shOYGE");
+    album.uid[6] = 0x04;
+    album.unreadable = true;
+    mfrc522.tag = &album;
+    RunSketch(300);
+    transactions = nfc.GetTotalTransactions();
+    RunSketch(1000);
+    EXPECT_GT(nfc.GetTotalTransactions(), transactions);
+    unsigned long plays = sketchApi.plays;
+    album.unreadable = false;
+    RunSketch(1500);
+    mfrc522.tag = nullptr;
+    RunSketch(500);
+
+    EXPECT_EQ(plays + 1, sketchApi.plays);
+    EXPECT_EQ("spotify:album:6dVIqQ8qmQ5GBnJ9shOYGE", sketchApi.playedUris.back());
+}
+
+// loadColor() used to hold Read() for 400 ms, twice, with delay() between frames
+TEST(Sketch, ReadDoesNotWaitOnTheLeds)
+{
+    BootSketch();
+    RunSketch(500);
+    HostTag album = MakeTag(Ntag213, "https://open.spotify.com/album/1ay9Z4R5ZYI2TY7WiDhNYQ");
+    album.uid[6] = 0x06;
+    std::vector<uint8_t> empty;
+    HostTag blank = MakeTag(Ntag213, empty);
+    blank.uid[6] = 0x07;
+    blank.memory[16] = TLV_TERMINATOR;
+
+    // the reading, playing and error feedback alike
+    for (HostTag *tag : {&album, &blank})
+    {
+        mfrc522.tag = tag;
+        byte atqa[2];
+        byte atqaSize = sizeof(atqa);
+        mfrc522.PICC_WakeupA(atqa, &atqaSize);
+        ASSERT_TRUE(mfrc522.PICC_ReadCardSerial());
+
+        unsigned long shows = pixels.shows;
+        uint64_t start = Host::Now();
+        EXPECT_TRUE(Read());
+        EXPECT_EQ(0u, Host::Now() - start);
+        EXPECT_EQ(shows, pixels.shows);
+        EXPECT_TRUE(animator.Active());
+
+        // the animation plays out over the passes that follow
+        mfrc522.PICC_HaltA();
+        mfrc522.tag = nullptr;
+        RunSketch(500);
+        EXPECT_GT(pixels.shows, shows);
+    }
+}
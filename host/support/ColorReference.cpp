@@ -0,0 +1,36 @@
+#include <math.h>
+#include "ColorReference.h"
+
+uint32_t FloatAmplitudeColor(uint8_t level)
+{
+    float hue = (170 - level * 170 / 255) / 256.0f * 6;
+    float value = level / 255.0f;
+    int sector = (int)hue;
+    float f = hue - sector;
+    float p = 0, q = value * (1 - f), t = value * f;
+    float r, g, b;
+    switch (sector)
+    {
+    case 0:
+        r = value, g = t, b = p;
+        break;
+    case 1:
+        r = q, g = value, b = p;
+        break;
+    case 2:
+        r = p, g = value, b = t;
+        break;
+    case 3:
+        r = p, g = q, b = value;
+        break;
+    case 4:
+        r = t, g = p, b = value;
+        break;
+    default:
+        r = value, g = p, b = q;
+        break;
+    }
+    auto gamma = [](float x)
+    { return (uint32_t)(powf(x, 2.5f) * 255 + 0.5f); };
+    return gamma(r) << 16 | gamma(g) << 8 | gamma(b);
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stdint.h>
+
+// AmplitudeColor() worked out at run time in floating point: HSV from blue
+// when quiet to red when loud, then pow() gamma 2.5. What the flash table is
+// tested and benchmarked against.
+uint32_t FloatAmplitudeColor(uint8_t level);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Clock.h"
+
+// A clock the test moves by hand, so hours of token lifetime pass without
+// simulating the network for as long
+class FakeClock : public Clock
+{
+public:
+    unsigned long now = 0;
+
+    unsigned long Millis() override { return now; }
+    void Advance(unsigned long millis) { now += millis; }
+};
@@ -0,0 +1,94 @@
+#include "JsonReference.h"
+
+String ReferenceParseJson(String key, String json)
+{
+    String retVal = "";
+    int index = json.indexOf(key);
+
+    if (index > 0)
+    {
+        bool copy = false;
+        for (int i = index; i < json.length(); i++)
+        {
+            if (copy)
+            {
+                if (json.charAt(i) == '"' || json.charAt(i) == ',')
+                {
+                    break;
+                }
+                else
+                {
+                    retVal += json.charAt(i);
+                }
+            }
+            else if (json.charAt(i) == ':')
+            {
+                copy = true;
+                if (json.charAt(i + 1) == '"')
+                {
+                    i++;
+                }
+            }
+        }
+    }
+    return retVal;
+}
+
+String ReferenceGetDeviceId(const String &deviceName, String json)
+{
+    String id = "";
+
+    // find the position the device name
+    int index = json.indexOf(deviceName);
+    if (index > 0)
+    {
+        // we found it, so not backup to begining of this object
+        int i = index;
+        for (; i > 0; i--)
+        {
+            if (json.charAt(i) == '{')
+            {
+                break;
+            }
+        }
+
+        // now move forward and find "id"
+        for (; i < json.length(); i++)
+        {
+            if (json.charAt(i) == '}')
+            {
+                break;
+            }
+
+            if (i + 3 < json.length() && json.charAt(i) == '"' && json.charAt(i + 1) == 'i' && json.charAt(i + 2) == 'd' && json.charAt(i + 3) == '"')
+            {
+                i += 4;
+                break;
+            }
+        }
+
+        // move forward to next "
+        for (; i < json.length(); i++)
+        {
+            if (json.charAt(i) == '"')
+            {
+                i++;
+                break;
+            }
+        }
+
+        // now get that device id
+        for (; i < json.length(); i++)
+        {
+            if (json.charAt(i) != '"')
+            {
+                id += json.charAt(i);
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+    return id;
+}
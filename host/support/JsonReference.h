@@ -0,0 +1,9 @@
+#pragma once
+
+#include <Arduino.h>
+
+// The parsers SpotifyClient had before JsonStreamParser: the whole body in
+// a String, taken by value and walked with charAt(), the result built up a
+// character at a time. What the streaming listeners are benchmarked against.
+String ReferenceParseJson(String key, String json);
+String ReferenceGetDeviceId(const String &deviceName, String json);
@@ -0,0 +1,258 @@
+#include <fstream>
+#include <sstream>
+#include "MockSpotify.h"
+#include "Host.h"
+
+static const char *const notFound = "{\"error\":{\"status\":404,\"message\":\"Device not found\"}}";
+static const char *const expired = "{\"error\":{\"status\":401,\"message\":\"The access token expired\"}}";
+
+std::string QueryParameter(const std::string &path, const std::string &name)
+{
+    size_t query = path.find('?');
+    while (query != std::string::npos)
+    {
+        size_t start = query + 1;
+        size_t end = path.find('&', start);
+        std::string pair = path.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (pair.compare(0, name.size() + 1, name + "=") == 0)
+        {
+            return pair.substr(name.size() + 1);
+        }
+        query = end;
+    }
+    return std::string();
+}
+
+std::string ReadDataFile(const char *name)
+{
+    std::ifstream file(std::string(HOST_DATA_DIR) + "/" + name, std::ios::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+static std::string FormValue(const std::string &body, const std::string &name)
+{
+    return QueryParameter("?" + body, name);
+}
+
+void MockAccounts::Handle(const HostHttpRequest &request, HostHttpResponse &response)
+{
+    if (request.method != "POST" || request.path != "/api/token")
+    {
+        response.status = 404;
+        return;
+    }
+    tokenRequests++;
+    lastRefreshToken = FormValue(request.body, "refresh_token");
+    lastAuthorization = request.Header("authorization");
+    response.headers.push_back(std::make_pair("Content-Type", "application/json"));
+    if (status != 200)
+    {
+        response.status = status;
+        response.body = "{\"error\":\"invalid_grant\",\"error_description\":\"Invalid refresh token\"}";
+        return;
+    }
+    issued++;
+    response.body = "{\"access_token\":\"" + CurrentToken() + "\",\"token_type\":\"Bearer\",\"expires_in\":" + std::to_string(expiresIn) +
+                    ",\"scope\":\"user-modify-playback-state user-read-playback-state\"";
+    if (!rotatedRefreshToken.empty())
+    {
+        response.body += ",\"refresh_token\":\"" + rotatedRefreshToken + "\"";
+    }
+    response.body += "}";
+}
+
+MockApi::MockApi()
+{
+    devices.push_back({"5fbb3ba6aa454b5534c4ba43a8c7e8e45a63ad0e", "Echo en la Glasgow", false});
+    devices.push_back({"a4f2c0e19d7b3e1c55a0f4b6e2d8c9a17b3f0e21", "Pixel 7", false});
+}
+
+std::string MockApi::TrackId() const
+{
+    // 22 base62 characters like the real ones
+    std::string id = "4iV5W9uYEdYUVa79Axb7" + std::to_string(10 + track % 90);
+    return id.substr(0, 22);
+}
+
+unsigned long MockApi::Progress() const
+{
+    unsigned long progress = progressAt;
+    if (playing)
+    {
+        progress += (unsigned long)((Host::Now() - startedAt) / 1000);
+    }
+    return progress;
+}
+
+// moves on to the next track whenever the current one has run out
+void MockApi::Follow()
+{
+    while (playing && Progress() >= trackDurations[track % trackDurations.size()])
+    {
+        unsigned long over = Progress() - trackDurations[track % trackDurations.size()];
+        track++;
+        progressAt = over;
+        startedAt = Host::Now();
+        Changed();
+    }
+}
+
+void MockApi::StartOn(const std::string &device, const std::string &uri, bool shuffled)
+{
+    activeDevice = device;
+    context = uri;
+    shuffle = shuffled;
+    playing = true;
+    track = 0;
+    progressAt = 0;
+    startedAt = Host::Now();
+    Changed();
+}
+
+void MockApi::PauseNow()
+{
+    Follow();
+    progressAt = Progress();
+    playing = false;
+    Changed();
+}
+
+void MockApi::SeekTo(unsigned long progressMs)
+{
+    progressAt = progressMs;
+    startedAt = Host::Now();
+    Changed();
+}
+
+bool MockApi::KnownDevice(const std::string &id) const
+{
+    for (const Device &device : devices)
+    {
+        if (device.id == id)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string MockApi::DevicesBody() const
+{
+    std::string body = "{\"devices\":[";
+    for (size_t i = 0; i < devices.size(); i++)
+    {
+        const Device &device = devices[i];
+        body += i ? "," : "";
+        body += "{\"id\":\"" + device.id + "\",\"is_active\":" + (device.id == activeDevice ? "true" : "false") +
+                ",\"is_private_session\":false,\"is_restricted\":false,\"name\":\"" + device.name +
+                "\",\"supports_volume\":true,\"type\":\"Speaker\",\"volume_percent\":65}";
+    }
+    return body + "]}";
+}
+
+std::string MockApi::PlayerBody() const
+{
+    std::string name;
+    for (const Device &device : devices)
+    {
+        if (device.id == activeDevice)
+        {
+            name = device.name;
+        }
+    }
+    std::string body = "{\"device\":{\"id\":\"" + activeDevice + "\",\"is_active\":true,\"name\":\"" + name +
+                       "\",\"type\":\"Speaker\",\"volume_percent\":65},\"shuffle_state\":" + (shuffle ? "true" : "false") +
+                       ",\"repeat_state\":\"off\",\"timestamp\":1700000000000,\"context\":{\"type\":\"album\",\"uri\":\"" + context +
+                       "\"},\"progress_ms\":" + std::to_string(Progress()) + ",\"item\":{\"album\":{\"id\":\"2noRn2Aes5aoNVsU6iWThc\",\"name\":\"" +
+                       std::string(playerPadding, 'x') + "\"},\"duration_ms\":" + std::to_string(trackDurations[track % trackDurations.size()]) +
+                       ",\"explicit\":false,\"id\":\"" + TrackId() + "\",\"name\":\"Track " + std::to_string(track + 1) +
+                       "\",\"type\":\"track\"},\"currently_playing_type\":\"track\",\"actions\":{\"disallows\":{\"resuming\":true}},\"is_playing\":" +
+                       (playing ? "true" : "false") + "}";
+    return body;
+}
+
+void MockApi::Handle(const HostHttpRequest &request, HostHttpResponse &response)
+{
+    Follow();
+    response.headers.push_back(std::make_pair("Content-Type", "application/json; charset=utf-8"));
+    if (!acceptedToken.empty() && request.Header("authorization") != "Bearer " + acceptedToken)
+    {
+        unauthorized++;
+        response.status = 401;
+        response.body = expired;
+        return;
+    }
+
+    std::string path = request.path.substr(0, request.path.find('?'));
+    std::string device = QueryParameter(request.path, "device_id");
+    if (request.method == "GET" && path == "/v1/me/player/devices")
+    {
+        response.body = devicesBody.empty() ? DevicesBody() : devicesBody;
+        return;
+    }
+    if (request.method == "GET" && path == "/v1/me/player")
+    {
+        playerPolls++;
+        if (activeDevice.empty())
+        {
+            response.status = 204;
+            return;
+        }
+        // progress is left out, it moves all the time and the client extrapolates it
+        std::string etag = "\"" + std::to_string(version) + "\"";
+        if (etags)
+        {
+            response.headers.push_back(std::make_pair("ETag", etag));
+            if (request.Header("if-none-match") == etag)
+            {
+                notModified++;
+                response.status = 304;
+                return;
+            }
+        }
+        response.body = PlayerBody();
+        return;
+    }
+    if (path == "/v1/me/player/play" || path == "/v1/me/player/shuffle" || path == "/v1/me/player/pause" || path == "/v1/me/player/next")
+    {
+        if (!KnownDevice(device))
+        {
+            response.status = 404;
+            response.body = notFound;
+            return;
+        }
+        response.status = 204;
+        if (path == "/v1/me/player/play")
+        {
+            plays++;
+            size_t start = request.body.find("\"context_uri\":\"");
+            std::string uri = start == std::string::npos ? std::string() : request.body.substr(start + 15, request.body.find('"', start + 15) - start - 15);
+            playedUris.push_back(uri);
+            StartOn(device, uri, shuffle);
+        }
+        else if (path == "/v1/me/player/shuffle")
+        {
+            shuffles++;
+            activeDevice = device;
+            shuffle = QueryParameter(request.path, "state") == "true";
+            Changed();
+        }
+        else if (path == "/v1/me/player/pause")
+        {
+            pauses++;
+            PauseNow();
+        }
+        else
+        {
+            track++;
+            progressAt = 0;
+            startedAt = Host::Now();
+            Changed();
+        }
+        return;
+    }
+    response.status = 404;
+    response.body = "{\"error\":{\"status\":404,\"message\":\"Service not found\"}}";
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "HostNetwork.h"
+
+// accounts.spotify.com, hands out access tokens for the refresh token
+class MockAccounts : public HostServer
+{
+public:
+    // status of the next answers, anything but 200 answers with an error
+    int status = 200;
+    long expiresIn = 3600;
+    // sent back as refresh_token when set, as Spotify does when it rotates it
+    std::string rotatedRefreshToken;
+    // makes the tokens as long as Spotify's, which run to 200 characters and more
+    size_t tokenPadding = 0;
+
+    unsigned long tokenRequests = 0;
+    std::string lastRefreshToken;
+    std::string lastAuthorization;
+
+    // the token handed out last, "token-<n>" and the padding
+    std::string CurrentToken() const { return "token-" + std::to_string(issued) + std::string(tokenPadding, 'x'); }
+
+    void Handle(const HostHttpRequest &request, HostHttpResponse &response) override;
+
+private:
+    unsigned long issued = 0;
+};
+
+// api.spotify.com: devices, the player and the commands the sketch sends.
+// Playback moves on with simulated time, the track ends and the next one
+// of the context starts.
+class MockApi : public HostServer
+{
+public:
+    struct Device
+    {
+        std::string id;
+        std::string name;
+        bool active;
+    };
+
+    std::vector<Device> devices;
+    // the bearer token accepted, empty accepts any
+    std::string acceptedToken;
+    // answers /v1/me/player/devices with this instead when set, for recorded payloads
+    std::string devicesBody;
+    // padding in the item of /v1/me/player, stands in for album, artists and images
+    size_t playerPadding = 1500;
+    bool etags = true;
+
+    // what is playing, on which device
+    std::string activeDevice;
+    std::string context;
+    bool playing = false;
+    bool shuffle = false;
+    std::vector<unsigned long> trackDurations = {215000, 187000, 243000, 201000, 176000, 229000};
+
+    unsigned long plays = 0;
+    unsigned long shuffles = 0;
+    unsigned long pauses = 0;
+    unsigned long playerPolls = 0;
+    unsigned long notModified = 0;
+    unsigned long unauthorized = 0;
+    std::vector<std::string> playedUris;
+
+    MockApi();
+    void Handle(const HostHttpRequest &request, HostHttpResponse &response) override;
+
+    // as if the user changed something in another Spotify app
+    void StartOn(const std::string &device, const std::string &uri, bool shuffled);
+    void PauseNow();
+    void SeekTo(unsigned long progressMs);
+
+    std::string TrackId() const;
+    unsigned long Progress() const;
+
+private:
+    size_t track = 0;
+    unsigned long progressAt = 0;
+    unsigned long long startedAt = 0;
+    unsigned long version = 1;
+
+    void Follow();
+    void Changed() { version++; }
+    bool KnownDevice(const std::string &id) const;
+    std::string PlayerBody() const;
+    std::string DevicesBody() const;
+};
+
+// Query parameter of a request path, empty when it is missing
+std::string QueryParameter(const std::string &path, const std::string &name);
+
+// Contents of a file in host/data
+std::string ReadDataFile(const char *name);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Host.h"
+#include "MockSpotify.h"
+#include "SpotifyClient.h"
+
+// Fresh simulated time with both Spotify hosts served by mocks
+class SpotifyHost
+{
+public:
+    MockAccounts accounts;
+    MockApi api;
+
+    SpotifyHost()
+    {
+        Host::Reset();
+        Host::SetYieldMicros(100);
+        Host::AddServer(SPOTIFY_ACCOUNTS_HOST, &accounts);
+        Host::AddServer(SPOTIFY_API_HOST, &api);
+    }
+    ~SpotifyHost() { Host::RemoveServers(); }
+};
+
+// Calls Loop() a millisecond apart, as the sketch does, until the queue is empty
+inline void RunUntilIdle(SpotifyClient &client, unsigned long limit = 60000)
+{
+    unsigned long start = millis();
+    do
+    {
+        client.Loop();
+        Host::Advance(1000);
+    } while (!client.Idle() && millis() - start < limit);
+}
@@ -0,0 +1,108 @@
+#include <stdlib.h>
+#include <sstream>
+#include "TagDump.h"
+#include "MockSpotify.h"
+
+std::vector<uint8_t> UriRecord(const std::string &link)
+{
+    std::string rest = link;
+    uint8_t prefix = 0x00;
+    if (rest.compare(0, 8, "https://") == 0)
+    {
+        prefix = 0x04;
+        rest = rest.substr(8);
+    }
+    std::vector<uint8_t> record = {0xD1, 0x01, (uint8_t)(rest.size() + 1), 'U', prefix};
+    for (char c : rest)
+    {
+        record.push_back((uint8_t)c);
+    }
+    return record;
+}
+
+HostTag MakeTag(HostTagType type, const std::vector<uint8_t> &message)
+{
+    // pages in total and the data area size the capability container announces
+    uint16_t pages = 16;
+    uint8_t dataSize = 0x06;
+    switch (type)
+    {
+    case Ntag213:
+        pages = 45;
+        dataSize = 0x12;
+        break;
+    case Ntag215:
+        pages = 135;
+        dataSize = 0x3E;
+        break;
+    case Ntag216:
+        pages = 231;
+        dataSize = 0x6D;
+        break;
+    default:
+        break;
+    }
+
+    HostTag tag;
+    tag.fastRead = type != Ultralight;
+    tag.memory.assign(pages * 4, 0x00);
+    memcpy(tag.memory.data(), tag.uid, 3);
+    tag.memory[3] = 0x88 ^ tag.uid[0] ^ tag.uid[1] ^ tag.uid[2];
+    memcpy(tag.memory.data() + 4, tag.uid + 3, 4);
+    tag.memory[8] = tag.uid[3] ^ tag.uid[4] ^ tag.uid[5] ^ tag.uid[6];
+    tag.memory[9] = 0x48;
+    uint8_t capability[4] = {0xE1, 0x10, dataSize, 0x00};
+    memcpy(tag.memory.data() + 12, capability, 4);
+
+    std::vector<uint8_t> tlv = {0x03};
+    if (message.size() < 0xFF)
+    {
+        tlv.push_back((uint8_t)message.size());
+    }
+    else
+    {
+        tlv.push_back(0xFF);
+        tlv.push_back((uint8_t)(message.size() >> 8));
+        tlv.push_back((uint8_t)message.size());
+    }
+    tlv.insert(tlv.end(), message.begin(), message.end());
+    tlv.push_back(0xFE);
+    size_t room = dataSize * 8;
+    if (tlv.size() > room)
+    {
+        tlv.resize(room);
+    }
+    memcpy(tag.memory.data() + 16, tlv.data(), tlv.size());
+    return tag;
+}
+
+HostTag MakeTag(HostTagType type, const std::string &link)
+{
+    return MakeTag(type, UriRecord(link));
+}
+
+HostTag LoadTag(const char *name)
+{
+    HostTag tag;
+    std::istringstream dump(ReadDataFile(name));
+    std::string line;
+    while (std::getline(dump, line))
+    {
+        if (line.size() < 8)
+        {
+            continue;
+        }
+        for (size_t i = 0; i < 8; i += 2)
+        {
+            tag.memory.push_back((uint8_t)strtoul(line.substr(i, 2).c_str(), nullptr, 16));
+        }
+    }
+    // UID0-2, BCC0, UID3-6
+    if (tag.memory.size() >= 8)
+    {
+        memcpy(tag.uid, tag.memory.data(), 3);
+        memcpy(tag.uid + 3, tag.memory.data() + 4, 4);
+        tag.uidSize = 7;
+    }
+    return tag;
+}
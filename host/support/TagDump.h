@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "MFRC522.h"
+
+enum HostTagType
+{
+    Ultralight,
+    Ntag213,
+    Ntag215,
+    Ntag216
+};
+
+// NDEF URI record of link, with the "https://" prefix code when it fits
+std::vector<uint8_t> UriRecord(const std::string &link);
+
+// A tag dump the way an NFC writing app leaves it: UID, lock bytes, the
+// capability container and an NDEF TLV holding message from page 4 on.
+// Ultralight answers FAST_READ with a NAK.
+HostTag MakeTag(HostTagType type, const std::vector<uint8_t> &message);
+HostTag MakeTag(HostTagType type, const std::string &link);
+
+// A dump in host/data, one page a line in hex like the Proxmark client's
+// .eml files. The UID is taken from the first pages.
+HostTag LoadTag(const char *name);
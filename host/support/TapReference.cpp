@@ -0,0 +1,94 @@
+#include "TapReference.h"
+
+RequestHandle ReferenceTapPath::PlaySpotifyUriAsync(String context_uri, RequestCallback callback)
+{
+    tapInProgress = true;
+
+    return QueuePlayAndShuffle(context_uri, [this, context_uri, callback](int httpCode)
+                               { PlayFinished(context_uri, httpCode, callback); });
+}
+
+RequestHandle ReferenceTapPath::QueuePlayAndShuffle(String context_uri, RequestCallback callback)
+{
+    RequestHandle handle = PlayAsync(context_uri, callback);
+    CallAPI("", nullptr);
+    return handle;
+}
+
+RequestHandle ReferenceTapPath::PlayAsync(String context_uri, RequestCallback callback)
+{
+    plays++;
+    FixedString<REQUEST_BODY_SIZE> body("{\"context_uri\":\"");
+    body.Append(context_uri.c_str()).Append("\",\"offset\":{\"position\":0,\"position_ms\":0}}");
+    return CallAPI(body.c_str(), callback);
+}
+
+void ReferenceTapPath::PlayFinished(String context_uri, int httpCode, RequestCallback callback)
+{
+    auto replay = [this, context_uri, callback](int)
+    {
+        QueuePlayAndShuffle(context_uri, callback);
+    };
+
+    switch (httpCode)
+    {
+    case 404:
+    case 401:
+    {
+        // new device id or new token first, then the play again
+        CallAPI("", replay);
+        return;
+    }
+    default:
+    {
+        break;
+    }
+    }
+
+    tapInProgress = false;
+    if (callback)
+    {
+        callback(httpCode);
+    }
+}
+
+RequestHandle ReferenceTapPath::CallAPI(const char *body, RequestCallback callback)
+{
+    if (queueCount == REQUEST_QUEUE_SIZE)
+    {
+        if (callback)
+        {
+            callback(HTTP_ERROR_QUEUE_FULL);
+        }
+        return 0;
+    }
+
+    Pending &pending = queue[(queueHead + queueCount) % REQUEST_QUEUE_SIZE];
+    pending.handle = nextHandle++;
+    pending.body.Clear();
+    pending.body.Append(body);
+    pending.callback = callback;
+    queueCount++;
+    return pending.handle;
+}
+
+bool ReferenceTapPath::Answer(int httpCode)
+{
+    if (queueCount == 0)
+    {
+        return false;
+    }
+    Pending &pending = queue[queueHead];
+    RequestCallback callback = pending.callback;
+
+    // free the slot before the callback, it may queue follow-up requests
+    pending.callback = nullptr;
+    queueHead = (queueHead + 1) % REQUEST_QUEUE_SIZE;
+    queueCount--;
+
+    if (callback)
+    {
+        callback(httpCode);
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "SpotifyClient.h"
+
+// The tap path of SpotifyClient before it took strings by const reference:
+// the URI passed by value down every call and captured by value in the
+// callbacks, which were copied into and out of the queue. Requests are
+// queued as before but answered by hand, so String::copies can be counted
+// over a tap the same way it is for the client.
+class ReferenceTapPath
+{
+public:
+    bool tapInProgress = false;
+    unsigned long plays = 0;
+
+    RequestHandle PlaySpotifyUriAsync(String context_uri, RequestCallback callback);
+    // answers the oldest queued request with httpCode, false when there is none
+    bool Answer(int httpCode);
+    uint8_t Queued() const { return queueCount; }
+
+private:
+    struct Pending
+    {
+        RequestHandle handle;
+        FixedString<REQUEST_BODY_SIZE> body;
+        RequestCallback callback;
+    };
+
+    Pending queue[REQUEST_QUEUE_SIZE];
+    uint8_t queueHead = 0;
+    uint8_t queueCount = 0;
+    RequestHandle nextHandle = 1;
+
+    RequestHandle QueuePlayAndShuffle(String context_uri, RequestCallback callback);
+    RequestHandle PlayAsync(String context_uri, RequestCallback callback);
+    void PlayFinished(String context_uri, int httpCode, RequestCallback callback);
+    RequestHandle CallAPI(const char *body, RequestCallback callback);
+};
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <random>
+#include "AudioSampler.h"
+#include "Host.h"
+
+namespace
+{
+    // every reading one more than the last, a gap or a repeat shows at once
+    uint32_t next = 0;
+
+    class AudioSamplerTest : public ::testing::Test
+    {
+    protected:
+        AudioSampler sampler;
+        uint32_t overruns = 0;
+        uint32_t missed = 0;
+
+        void SetUp() override
+        {
+            Host::Reset();
+            next = 0;
+            Host::SetAnalogSource([](uint8_t pin)
+                                  { return (int)(next++ & 1023); });
+            // the buffer is shared by all samplers, start from empty
+            sampler.Skip(sampler.Available());
+            overruns = sampler.GetOverruns();
+            missed = sampler.GetMissed();
+            sampler.Begin();
+        }
+
+        void TearDown() override
+        {
+            sampler.End();
+            Host::SetAnalogSource(nullptr);
+        }
+
+        // drains what is there in batches of up to batch, checking the sequence
+        unsigned long Drain(uint16_t batch, int16_t &expected)
+        {
+            unsigned long read = 0;
+            int16_t out[AUDIO_BUFFER_SIZE];
+            while (sampler.Available() > 0)
+            {
+                uint16_t count = sampler.Available() < batch ? sampler.Available() : batch;
+                EXPECT_TRUE(sampler.Read(out, count));
+                for (uint16_t i = 0; i < count; i++)
+                {
+                    EXPECT_EQ(expected, out[i]) << "sample " << read + i;
+                    expected = (expected + 1) & 1023;
+                }
+                read += count;
+            }
+            return read;
+        }
+    };
+}
+
+TEST_F(AudioSamplerTest, NothingIsLostBetweenDrains)
+{
+    std::mt19937 random(20);
+    int16_t expected = 0;
+    unsigned long read = 0;
+    // an hour of loop() passes from a millisecond to most of a buffer apart,
+    // drained a hop at a time like the sketch does, or in odd batches
+    while (Host::Now() < 3600ull * 1000000)
+    {
+        Host::AdvanceMillis(1 + random() % (AUDIO_BUFFER_SIZE * AUDIO_SAMPLE_INTERVAL - 10));
+        read += Drain(random() % 2 ? 8 : 1 + random() % 40, expected);
+    }
+    printf("%lu samples in %llu s, %u overruns\n", read, (unsigned long long)(Host::Now() / 1000000), sampler.GetOverruns() - overruns);
+
+    EXPECT_EQ((unsigned long)next, read);
+    EXPECT_EQ((unsigned long)AUDIO_SAMPLE_RATE * Host::Now() / 1000000, read);
+    EXPECT_EQ(0u, sampler.GetOverruns() - overruns);
+    EXPECT_EQ(0u, sampler.GetMissed() - missed);
+}
+
+TEST_F(AudioSamplerTest, BlockedTicksAreCountedAsMissed)
+{
+    int16_t expected = 0;
+    unsigned long read = 0;
+    Host::AdvanceMillis(100);
+    read += Drain(8, expected);
+    EXPECT_EQ(100u / AUDIO_SAMPLE_INTERVAL, read);
+
+    // a full TLS handshake holds the CPU and no tick runs: nothing is
+    // sampled, nothing overruns, and the late tick finds the hole
+    Host::Stall(400000);
+    EXPECT_EQ(0, sampler.Available());
+    Host::AdvanceMillis(1);
+    read += Drain(8, expected);
+    EXPECT_EQ(400u / AUDIO_SAMPLE_INTERVAL - 1, sampler.GetMissed() - missed);
+    EXPECT_EQ(0u, sampler.GetOverruns() - overruns);
+
+    // sampling carries on at the rate with nothing more missed
+    uint32_t afterHandshake = sampler.GetMissed();
+    Host::AdvanceMillis(100);
+    EXPECT_EQ(100u / AUDIO_SAMPLE_INTERVAL, Drain(8, expected));
+    EXPECT_EQ(afterHandshake, sampler.GetMissed());
+
+    // a stream of resumed handshakes at any phase of the interval: every
+    // interval is a sample or is counted as missed
+    read = 0;
+    uint32_t missedBefore = sampler.GetMissed();
+    uint64_t start = Host::Now();
+    for (int i = 0; i < 50; i++)
+    {
+        Host::Advance(1000 + i * 777 % 20000);
+        Host::Stall(80000);
+        Host::Advance(1000);
+        read += Drain(8, expected);
+    }
+    unsigned long intervals = (Host::Now() - start) / (AUDIO_SAMPLE_INTERVAL * 1000);
+    uint32_t missedNow = sampler.GetMissed() - missedBefore;
+    printf("%lu intervals, %lu samples, %u missed\n", intervals, read, missedNow);
+    EXPECT_NEAR(intervals, read + missedNow, 1);
+    EXPECT_GE(missedNow, 50u * (80 / AUDIO_SAMPLE_INTERVAL - 1));
+    EXPECT_EQ(0u, sampler.GetOverruns() - overruns);
+}
+
+TEST_F(AudioSamplerTest, UndrainedBufferLosesOnlyTheNewestAndCountsThem)
+{
+    int16_t expected = 0;
+    // loop() stuck in delay() for a second: ticks run, nobody drains
+    delay(1000);
+    EXPECT_EQ(AUDIO_BUFFER_SIZE, sampler.Available());
+    EXPECT_EQ((uint32_t)(AUDIO_SAMPLE_RATE - AUDIO_BUFFER_SIZE), sampler.GetOverruns() - overruns);
+    EXPECT_EQ(0u, sampler.GetMissed() - missed);
+    EXPECT_EQ((unsigned long)AUDIO_BUFFER_SIZE, Drain(8, expected));
+
+    // what was buffered is whole, sampling carries on after the gap
+    expected = (int16_t)(next & 1023);
+    Host::AdvanceMillis(100);
+    EXPECT_EQ(100u / AUDIO_SAMPLE_INTERVAL, Drain(8, expected));
+    EXPECT_EQ((uint32_t)(AUDIO_SAMPLE_RATE - AUDIO_BUFFER_SIZE), sampler.GetOverruns() - overruns);
+}
+
+TEST(RingBuffer, IndicesWrapWithoutLoss)
+{
+    RingBuffer<uint16_t, 8> buffer;
+    std::mt19937 random(3);
+    uint16_t pushed = 0;
+    uint16_t expected = 0;
+    // well past the 16 bit indices wrapping, with the buffer at every fill level
+    for (long i = 0; i < 300000; i++)
+    {
+        int pushes = random() % 6;
+        for (int p = 0; p < pushes && buffer.Available() < 8; p++)
+        {
+            ASSERT_TRUE(buffer.Push(pushed++));
+        }
+        uint16_t out[8];
+        uint16_t count = buffer.Read(out, random() % 6);
+        for (uint16_t c = 0; c < count; c++)
+        {
+            ASSERT_EQ(expected++, out[c]);
+        }
+    }
+    EXPECT_EQ(0u, buffer.GetOverruns());
+
+    // all eight slots are usable, the ninth push is counted and dropped
+    buffer.Skip(buffer.Available());
+    for (int p = 0; p < 8; p++)
+    {
+        EXPECT_TRUE(buffer.Push(pushed++));
+    }
+    EXPECT_FALSE(buffer.Push(pushed));
+    EXPECT_EQ(1u, buffer.GetOverruns());
+}
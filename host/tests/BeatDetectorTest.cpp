@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <math.h>
+#include <random>
+#include "AudioSampler.h"
+#include "BeatDetector.h"
+#include "Spectrum.h"
+
+namespace
+{
+    // A click track as the microphone hears it at AUDIO_SAMPLE_RATE: a kick
+    // drum every beat, a 60 Hz thump dying away within 80 ms, over room noise
+    std::vector<int16_t> ClickTrack(double bpm, double seconds, unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::normal_distribution<double> noise(0, 6);
+        std::vector<int16_t> samples((size_t)(seconds * AUDIO_SAMPLE_RATE));
+        double beat = 60.0 / bpm;
+        for (size_t i = 0; i < samples.size(); i++)
+        {
+            double t = (double)i / AUDIO_SAMPLE_RATE;
+            double since = fmod(t, beat);
+            double kick = 350 * exp(-since / 0.025) * sin(2 * M_PI * 60 * since);
+            samples[i] = (int16_t)lround(512 + kick + noise(random));
+        }
+        return samples;
+    }
+
+    // runs samples through the sketch's frame by frame path, returns the
+    // beats; nanos gets the host time of each frame
+    unsigned long Detect(BeatDetector &detector, const std::vector<int16_t> &samples, std::vector<uint64_t> *nanos = nullptr)
+    {
+        Spectrum spectrum;
+        int16_t frame[FFT_SIZE] = {};
+        uint8_t levels[SPECTRUM_BANDS];
+        unsigned long beats = 0;
+        for (size_t hop = 0; hop + FFT_HOP <= samples.size(); hop += FFT_HOP)
+        {
+            memmove(frame, frame + FFT_HOP, (FFT_SIZE - FFT_HOP) * sizeof(int16_t));
+            memcpy(frame + FFT_SIZE - FFT_HOP, &samples[hop], FFT_HOP * sizeof(int16_t));
+            auto start = std::chrono::steady_clock::now();
+            spectrum.Analyze(frame, levels);
+            beats += detector.Update(spectrum.GetMagnitudes());
+            if (nanos)
+            {
+                nanos->push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            }
+        }
+        return beats;
+    }
+
+    class BeatDetectorBpm : public ::testing::TestWithParam<int>
+    {
+    };
+}
+
+TEST_P(BeatDetectorBpm, FindsTheTempoOfAClickTrack)
+{
+    const int bpm = GetParam();
+    const double seconds = 20;
+    BeatDetector detector;
+    unsigned long beats = Detect(detector, ClickTrack(bpm, seconds, bpm), nullptr);
+
+    double found = detector.GetBpm() / 10.0;
+    double expected = bpm * seconds / 60;
+    printf("%d BPM: found %.1f BPM, %lu onsets, %lu beats of %.0f\n", bpm, found, detector.GetOnsets(), beats, expected);
+    RecordProperty("bpm_x10", detector.GetBpm());
+    EXPECT_NEAR(bpm, found, bpm * 0.01);
+    // every kick is heard, a beat or two are still finding the tempo
+    EXPECT_NEAR(expected, detector.GetOnsets(), 2);
+    EXPECT_NEAR(expected, beats, 2);
+}
+
+INSTANTIATE_TEST_SUITE_P(ClickTracks, BeatDetectorBpm, ::testing::Values(70, 100, 120, 160));
+
+TEST(BeatDetector, NoiseHasNoTempo)
+{
+    std::mt19937 random(7);
+    std::normal_distribution<double> noise(0, 6);
+    std::vector<int16_t> samples(20 * AUDIO_SAMPLE_RATE);
+    for (int16_t &sample : samples)
+    {
+        sample = (int16_t)lround(512 + noise(random));
+    }
+    BeatDetector detector;
+    Detect(detector, samples);
+    EXPECT_EQ(0, detector.GetBpm());
+    EXPECT_LT(detector.GetOnsets(), 5u);
+}
+
+// The frames that also estimate the tempo are the costly ones. The host is
+// many times faster than the ESP8266 and a frame has to stay far inside the
+// 40 ms between frames there, so on average tens of microseconds here are
+// already a failure. Averages, so a preempted frame does not fail the test.
+TEST(BeatDetector, FrameCostIsBounded)
+{
+    BeatDetector detector;
+    std::vector<uint64_t> nanos;
+    Detect(detector, ClickTrack(120, 20, 1), &nanos);
+
+    uint64_t plain = 0;
+    uint64_t tempo = 0;
+    for (size_t frame = 0; frame < nanos.size(); frame++)
+    {
+        (frame % BEAT_TEMPO_INTERVAL == BEAT_TEMPO_INTERVAL - 1 ? tempo : plain) += nanos[frame];
+    }
+    size_t tempoFrames = nanos.size() / BEAT_TEMPO_INTERVAL;
+    plain /= nanos.size() - tempoFrames;
+    tempo /= tempoFrames;
+    printf("%zu frames, %llu ns a frame, %llu ns with the tempo estimate\n", nanos.size(), (unsigned long long)plain, (unsigned long long)tempo);
+    RecordProperty("frame_ns", (int)plain);
+    RecordProperty("tempo_frame_ns", (int)tempo);
+    EXPECT_LT(plain, 20000u);
+    EXPECT_LT(tempo, 50000u);
+    EXPECT_GT(tempo, plain);
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "CardDetector.h"
+#include "FakeClock.h"
+#include "Host.h"
+#include "TagDump.h"
+
+#define TEST_IRQ_PIN 4
+#define TEST_INTERVAL 100
+
+namespace
+{
+    // The simulated reader answers a WUPA through the IRQ pin the moment it
+    // goes out, the clock only moves the intervals along
+    class CardDetectorTest : public ::testing::Test
+    {
+    protected:
+        FakeClock clock;
+        MFRC522 mfrc522{15, 0};
+        CardDetector detector{mfrc522, TEST_IRQ_PIN, TEST_INTERVAL, clock};
+        HostTag tag = MakeTag(Ntag213, "spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ");
+        unsigned long polls = 0;
+        unsigned long seen = 0;
+
+        void SetUp() override
+        {
+            Host::Reset();
+            mfrc522.irqPin = TEST_IRQ_PIN;
+            mfrc522.PCD_Init();
+            detector.Begin();
+        }
+
+        // polls every millisecond like loop() does, halting what it found as the sketch does once read
+        void PollFor(unsigned long millis)
+        {
+            for (unsigned long i = 0; i < millis; i++)
+            {
+                clock.Advance(1);
+                bool present = false;
+                if (detector.Poll(present))
+                {
+                    polls++;
+                    if (present)
+                    {
+                        seen++;
+                        mfrc522.PICC_HaltA();
+                    }
+                }
+            }
+        }
+    };
+}
+
+TEST_F(CardDetectorTest, EmptyFieldSendsOnlyTheWakeup)
+{
+    unsigned long accesses = mfrc522.registerAccesses;
+    size_t writes = mfrc522.writes.size();
+    unsigned long transactions = detector.GetTransactions();
+    PollFor(10000 + CARD_ANSWER_TIMEOUT);
+
+    EXPECT_EQ(100u, polls);
+    EXPECT_EQ(0u, seen);
+    EXPECT_EQ(polls, mfrc522.exchanges);
+    // seven commands an interval, the only read is the one CollReg takes to clear a bit
+    EXPECT_EQ(7 * polls, detector.GetTransactions() - transactions);
+    EXPECT_EQ(polls, (mfrc522.registerAccesses - accesses) - (mfrc522.writes.size() - writes));
+    printf("%lu reader transactions/s with the field empty\n", (detector.GetTransactions() - transactions) / 10);
+}
+
+TEST_F(CardDetectorTest, CardIsSelectedOnTheNextInterval)
+{
+    PollFor(250);
+    ASSERT_EQ(0u, seen);
+
+    mfrc522.tag = &tag;
+    PollFor(TEST_INTERVAL);
+    EXPECT_EQ(1u, seen);
+    EXPECT_EQ(0, memcmp(tag.uid, mfrc522.uid.uidByte, tag.uidSize));
+
+    // halted after each read and woken again by the next WUPA, though the
+    // library's exchanges in between left the pin low
+    PollFor(5 * TEST_INTERVAL);
+    EXPECT_EQ(6u, seen);
+
+    mfrc522.tag = nullptr;
+    PollFor(5 * TEST_INTERVAL);
+    EXPECT_EQ(6u, seen);
+}
+
+TEST_F(CardDetectorTest, WakeupGoesOutOnAFlushedFifo)
+{
+    mfrc522.tag = &tag;
+    // a MIFARE_Read cut short left its command in the FIFO, an earlier
+    // anticollision left ValuesAfterColl set
+    mfrc522.fifo = {MFRC522::PICC_CMD_MF_READ, 4};
+    mfrc522.PCD_WriteRegister(MFRC522::CollReg, 0x80);
+    mfrc522.writes.clear();
+    PollFor(TEST_INTERVAL + 1);
+
+    ASSERT_EQ(1u, seen);
+    const std::vector<std::pair<byte, byte>> arm = {
+        {MFRC522::CommandReg, MFRC522::PCD_Idle},
+        {MFRC522::ComIrqReg, MFRC522_IRQ_CLEAR},
+        {MFRC522::FIFOLevelReg, MFRC522_FIFO_FLUSH},
+        {MFRC522::CollReg, 0x00},
+        {MFRC522::FIFODataReg, MFRC522::PICC_CMD_WUPA},
+        {MFRC522::CommandReg, MFRC522::PCD_Transceive},
+        {MFRC522::BitFramingReg, MFRC522_SHORT_FRAME_SEND},
+    };
+    ASSERT_LE(arm.size(), mfrc522.writes.size());
+    std::vector<std::pair<byte, byte>> written(mfrc522.writes.begin(), mfrc522.writes.begin() + arm.size());
+    EXPECT_EQ(arm, written);
+}
+
+TEST(CardDetectorWithoutPin, WakesAndSelectsEveryInterval)
+{
+    Host::Reset();
+    FakeClock clock;
+    MFRC522 mfrc522(15, 0);
+    CardDetector detector(mfrc522, -1, TEST_INTERVAL, clock);
+    detector.Begin();
+    HostTag tag = MakeTag(Ntag213, "spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ");
+
+    bool present = true;
+    clock.Advance(TEST_INTERVAL);
+    ASSERT_TRUE(detector.Poll(present));
+    EXPECT_FALSE(present);
+    EXPECT_EQ(1u, detector.GetTransactions());
+
+    mfrc522.tag = &tag;
+    EXPECT_FALSE(detector.Poll(present));
+    clock.Advance(TEST_INTERVAL);
+    ASSERT_TRUE(detector.Poll(present));
+    EXPECT_TRUE(present);
+    EXPECT_EQ(3u, detector.GetTransactions());
+}
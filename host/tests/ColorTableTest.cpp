@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+#include "ColorReference.h"
+#include "ColorTable.h"
+
+TEST(ColorTable, AmplitudeColorMatchesFloatingPoint)
+{
+    int worst = 0;
+    for (int level = 0; level < AMPLITUDE_TABLE_SIZE; level++)
+    {
+        uint32_t table = AmplitudeColor(level);
+        uint32_t reference = FloatAmplitudeColor(level);
+        for (int shift = 0; shift < 24; shift += 8)
+        {
+            int difference = abs((int)((table >> shift) & 0xFF) - (int)((reference >> shift) & 0xFF));
+            worst = std::max(worst, difference);
+        }
+    }
+    // integer HSV rounds each step down
+    EXPECT_LE(worst, 2);
+    EXPECT_EQ(0x000000u, AmplitudeColor(0));
+    EXPECT_EQ(0xFF0000u, AmplitudeColor(255));
+}
+
+TEST(ColorTable, GammaEnds)
+{
+    EXPECT_EQ(0, Gamma8(0));
+    EXPECT_EQ(255, Gamma8(255));
+    // 2.5 gamma: half of the input is under a fifth of the light
+    EXPECT_EQ(46, Gamma8(128));
+    for (int i = 1; i < GAMMA_TABLE_SIZE; i++)
+    {
+        EXPECT_GE(Gamma8(i), Gamma8(i - 1));
+    }
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include "HttpRequest.h"
+#include "Host.h"
+#include "HostNetwork.h"
+
+namespace
+{
+    class NoContentServer : public HostServer
+    {
+    public:
+        void Handle(const HostHttpRequest &request, HostHttpResponse &response) override { response.status = 204; }
+    };
+
+    class ConnectionPoolTest : public ::testing::Test
+    {
+    protected:
+        NoContentServer server;
+
+        void SetUp() override
+        {
+            Host::Reset();
+            Host::AddServer(SPOTIFY_API_HOST, &server);
+        }
+        void TearDown() override { Host::RemoveServers(); }
+
+        int Send(HttpRequest &request)
+        {
+            request.Begin("PUT", SPOTIFY_API_HOST, "/v1/me/player/pause", "Bearer", "token", "application/json", "", nullptr);
+            while (request.Step())
+            {
+                Host::Advance(1000);
+            }
+            return request.GetHttpCode();
+        }
+    };
+}
+
+TEST_F(ConnectionPoolTest, CountsFullAndResumedHandshakes)
+{
+    ConnectionPool pool;
+    HttpRequest request(pool);
+
+    ASSERT_EQ(204, Send(request));
+    ASSERT_EQ(204, Send(request));
+    EXPECT_EQ(1u, pool.GetHits());
+    EXPECT_EQ(1u, pool.GetFullHandshakes());
+    EXPECT_EQ(0u, pool.GetResumedHandshakes());
+
+    // a reconnect offers the cached session and the server takes it
+    server.DropConnections();
+    ASSERT_EQ(204, Send(request));
+    EXPECT_EQ(1u, pool.GetFullHandshakes());
+    EXPECT_EQ(1u, pool.GetResumedHandshakes());
+
+    // a server that lost its cache answers with a new session
+    server.DropConnections();
+    server.ForgetSessions();
+    ASSERT_EQ(204, Send(request));
+    server.DropConnections();
+    ASSERT_EQ(204, Send(request));
+    EXPECT_EQ(2u, pool.GetFullHandshakes());
+    EXPECT_EQ(2u, pool.GetResumedHandshakes());
+
+    // what the pool counted is what the server saw
+    EXPECT_EQ(server.fullHandshakes, pool.GetFullHandshakes());
+    EXPECT_EQ(server.resumedHandshakes, pool.GetResumedHandshakes());
+}
+
+TEST_F(ConnectionPoolTest, StoredSessionIsResumedAfterReboot)
+{
+    fs::FS store;
+    store.begin();
+    {
+        ConnectionPool pool;
+        pool.SetSessionStore(&store);
+        HttpRequest request(pool);
+        ASSERT_EQ(204, Send(request));
+        EXPECT_EQ(1u, pool.GetFullHandshakes());
+    }
+
+    server.DropConnections();
+    ConnectionPool rebooted;
+    rebooted.SetSessionStore(&store);
+    HttpRequest request(rebooted);
+    ASSERT_EQ(204, Send(request));
+    EXPECT_EQ(0u, rebooted.GetFullHandshakes());
+    EXPECT_EQ(1u, rebooted.GetResumedHandshakes());
+    EXPECT_EQ(1u, server.resumedHandshakes);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "HeapStats.h"
+#include "SpotifyHost.h"
+
+// 100k taps with a player poll every few of them, the token refreshed in the
+// background as it runs out. The simulated heap shows whether the request
+// path leaves holes behind that add up over days of uptime.
+TEST(HeapSoak, LargestFreeBlockHoldsOverHundredThousandTaps)
+{
+    // the sketch holds the uri in a String already, it is not the client's to allocate
+    const String uris[] = {
+        "spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ",
+        "spotify:playlist:37i9dQZF1DXcBWIGoYBM5M",
+        "spotify:artist:0OdUWJ0sBjDrqHygGUXeCF",
+        "spotify:album:6dVIqQ8qmQ5GBnJ9shOYGE",
+    };
+    const unsigned long taps = 100000;
+
+    SpotifyHost host;
+    host.accounts.tokenPadding = 200;
+    SpotifyClient client("client", "secret", "Echo en la Glasgow", "refresh-1");
+    client.FetchToken();
+    client.GetDevices();
+    ASSERT_TRUE(client.HasDevice());
+
+    unsigned long played = 0;
+    size_t largestEarly = 0;
+    HeapStats::Begin();
+    size_t largestAtStart = HeapStats::LargestFreeBlock();
+    for (unsigned long tap = 0; tap < taps; tap++)
+    {
+        client.PlaySpotifyUriAsync(uris[tap % 4], [&](int httpCode)
+                                   { played += httpCode == 204; });
+        RunUntilIdle(client);
+        if (tap % 8 == 0)
+        {
+            client.GetPlayerAsync();
+            RunUntilIdle(client);
+        }
+        if (tap == 1000)
+        {
+            largestEarly = HeapStats::LargestFreeBlock();
+        }
+    }
+    size_t largest = HeapStats::LargestFreeBlock();
+    HeapStats::End();
+
+    printf("%lu taps over %lu s simulated: %lu allocations, peak %zu bytes, largest free block %zu of %zu bytes (%zu after 1000 taps)\n",
+           taps, millis() / 1000, HeapStats::Allocations(), HeapStats::PeakBytes(), largest, largestAtStart, largestEarly);
+    RecordProperty("allocations", (int)HeapStats::Allocations());
+    RecordProperty("peak_bytes", (int)HeapStats::PeakBytes());
+    RecordProperty("largest_free_block", (int)largest);
+
+    EXPECT_EQ(taps, played);
+    EXPECT_GT(host.accounts.tokenRequests, 1u);
+    EXPECT_EQ(0u, HeapStats::Failures());
+    // whatever the first taps leave allocated, later ones do not carve it up further
+    EXPECT_EQ(largestEarly, largest);
+}
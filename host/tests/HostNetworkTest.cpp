@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <WiFiClientSecure.h>
+#include "Host.h"
+#include "HostNetwork.h"
+
+namespace
+{
+    class EchoServer : public HostServer
+    {
+    public:
+        void Handle(const HostHttpRequest &request, HostHttpResponse &response) override
+        {
+            response.body = request.method + " " + request.path;
+        }
+    };
+
+    std::string Drain(WiFiClient &client)
+    {
+        std::string text;
+        while (client.connected())
+        {
+            int c = client.read();
+            if (c < 0)
+            {
+                Host::Advance(1000);
+                continue;
+            }
+            text += (char)c;
+        }
+        return text;
+    }
+
+    class HostNetworkTest : public ::testing::Test
+    {
+    protected:
+        EchoServer server;
+
+        void SetUp() override
+        {
+            Host::Reset();
+            Host::AddServer("example.com", &server);
+        }
+        void TearDown() override { Host::RemoveServers(); }
+    };
+}
+
+TEST_F(HostNetworkTest, HandshakeAndRoundTripCostSimulatedTime)
+{
+    BearSSL::Session session;
+    WiFiClientSecure client;
+    client.setSession(&session);
+
+    ASSERT_TRUE(client.connect("example.com", 443));
+    EXPECT_EQ(server.fullHandshakeMillis * 1000, Host::Now());
+    client.print("GET /a HTTP/1.1\r\nHost: example.com\r\nConnection: close\r\n\r\n");
+    EXPECT_EQ(0, client.available());
+    Host::AdvanceMillis(server.roundTripMillis);
+    std::string response = Drain(client);
+    EXPECT_NE(std::string::npos, response.find("HTTP/1.1 200 OK"));
+    EXPECT_NE(std::string::npos, response.find("GET /a"));
+
+    // the session id handed out the first time buys the short handshake
+    WiFiClientSecure again;
+    again.setSession(&session);
+    uint64_t before = Host::Now();
+    ASSERT_TRUE(again.connect("example.com", 443));
+    EXPECT_EQ(server.resumedHandshakeMillis * 1000, Host::Now() - before);
+    EXPECT_EQ(1u, server.fullHandshakes);
+    EXPECT_EQ(1u, server.resumedHandshakes);
+}
+
+TEST_F(HostNetworkTest, IdleConnectionsAreClosedByTheServer)
+{
+    WiFiClientSecure client;
+    ASSERT_TRUE(client.connect("example.com", 443));
+    EXPECT_TRUE(client.connected());
+    Host::AdvanceMillis(server.keepAliveMillis + 1);
+    EXPECT_FALSE(client.connected());
+    EXPECT_FALSE(client.connect("unknown.example.com", 443));
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "HttpRequest.h"
+#include "Host.h"
+#include "HostNetwork.h"
+
+namespace
+{
+    class BodyServer : public HostServer
+    {
+    public:
+        size_t length = 0;
+
+        void Handle(const HostHttpRequest &request, HostHttpResponse &response) override
+        {
+            response.body = std::string(length, 'x');
+        }
+    };
+
+    // takes a body of any length and only counts it
+    class CountingSink : public Stream
+    {
+    public:
+        size_t written = 0;
+
+        int available() override { return 0; }
+        int read() override { return -1; }
+        int peek() override { return -1; }
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t *buffer, size_t size) override
+        {
+            written += size;
+            return size;
+        }
+    };
+
+    class HttpRequestTest : public ::testing::Test
+    {
+    protected:
+        BodyServer server;
+        ConnectionPool pool;
+        CountingSink sink;
+
+        void SetUp() override
+        {
+            Host::Reset();
+            Host::AddServer(SPOTIFY_API_HOST, &server);
+        }
+        void TearDown() override { Host::RemoveServers(); }
+
+        // Step() calls for a fresh request, connection and all
+        int Steps(size_t length)
+        {
+            server.length = length;
+            server.DropConnections();
+            HttpRequest request(pool);
+            request.Begin("GET", SPOTIFY_API_HOST, "/v1/me/player", "Bearer", "token", "", "", &sink);
+            int steps = 1;
+            while (request.Step())
+            {
+                Host::Advance(1000);
+                steps++;
+            }
+            EXPECT_EQ(200, request.GetHttpCode());
+            return steps;
+        }
+    };
+}
+
+TEST_F(HttpRequestTest, StepReadsAFullBudgetOfBody)
+{
+    const size_t length = 16 * HTTP_STEP_BUDGET;
+    // the same request with and without a body, the difference is the body
+    int empty = Steps(0);
+    int full = Steps(length);
+    EXPECT_EQ(length, sink.written);
+
+    // the whole response waits in the socket, so every step reads a whole
+    // budget although a single read only takes a buffer's worth
+    printf("%zu byte body in %d steps\n", length, full - empty);
+    EXPECT_LE(full - empty, 16 + 1);
+}
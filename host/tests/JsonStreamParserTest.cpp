@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "JsonStreamParser.h"
+
+namespace
+{
+    class Collector : public JsonListener
+    {
+    public:
+        std::vector<std::pair<std::string, std::string>> values;
+
+        void Value(const char *key, const char *value, uint8_t depth) override { values.push_back(std::make_pair(key, value)); }
+    };
+
+    std::string ValueOf(const char *json)
+    {
+        Collector collector;
+        JsonStreamParser parser(collector);
+        parser.write(reinterpret_cast<const uint8_t *>(json), strlen(json));
+        return collector.values.empty() ? std::string() : collector.values.front().second;
+    }
+}
+
+TEST(JsonStreamParser, DecodesUnicodeEscapesToUtf8)
+{
+    EXPECT_EQ("Echo en la Glasg\xC3\xB3w", ValueOf("{\"name\":\"Echo en la Glasg\\u00f3w\"}"));
+    EXPECT_EQ("\xE2\x82\xAC", ValueOf("{\"name\":\"\\u20AC\"}"));
+    EXPECT_EQ("A/B", ValueOf("{\"name\":\"\\u0041\\/B\"}"));
+    // outside the BMP, as a surrogate pair
+    EXPECT_EQ("\xF0\x9F\x8E\xB5", ValueOf("{\"name\":\"\\ud83c\\udfb5\"}"));
+    EXPECT_EQ("\xEF\xBF\xBDx", ValueOf("{\"name\":\"\\ud83cx\"}"));
+}
+
+TEST(JsonStreamParser, DecodesEscapesSplitAcrossWrites)
+{
+    Collector collector;
+    JsonStreamParser parser(collector);
+    const char *json = "{\"name\":\"caf\\u00e9\",\"id\":\"1\"}";
+    for (const char *c = json; *c; c++)
+    {
+        parser.write((uint8_t)*c);
+    }
+    ASSERT_EQ(2u, collector.values.size());
+    EXPECT_EQ("caf\xC3\xA9", collector.values[0].second);
+    EXPECT_EQ("1", collector.values[1].second);
+}
+
+TEST(JsonStreamParser, TruncatesLongValuesOnCharacterBoundaries)
+{
+    std::string json = "{\"name\":\"" + std::string(JSON_VALUE_SIZE - 2, 'a') + "\\u00e9\"}";
+    std::string value = ValueOf(json.c_str());
+    EXPECT_EQ(std::string(JSON_VALUE_SIZE - 2, 'a'), value);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <Adafruit_NeoPixel.h>
+#include "NeoPixelBusOutput.h"
+#include "NeoPixelOutput.h"
+
+namespace
+{
+    template <typename Method>
+    class NeoPixelBusOutputTest : public ::testing::Test
+    {
+    };
+
+    typedef ::testing::Types<NeoEsp8266Dma800KbpsMethod, NeoEsp8266Uart1800KbpsMethod, NeoEsp8266AsyncUart1800KbpsMethod> Methods;
+    TYPED_TEST_SUITE(NeoPixelBusOutputTest, Methods);
+
+    uint32_t Bytes(RgbColor color)
+    {
+        return (uint32_t)color.R << 16 | (uint32_t)color.G << 8 | color.B;
+    }
+}
+
+// Switching the backend must not change what the strip shows
+TYPED_TEST(NeoPixelBusOutputTest, BrightnessScalesLikeAdafruit)
+{
+    const uint32_t colors[] = {0x000000, 0xFFFFFF, 0x010203, 0x808080, 0xFF7F01, 0x123456, 0xFEDCBA};
+    const uint16_t count = sizeof(colors) / sizeof(colors[0]);
+    for (int brightness : {0, 1, 50, 127, 128, 254, 255})
+    {
+        Adafruit_NeoPixel adafruit(count);
+        NeoPixelOutput reference(adafruit);
+        reference.Begin(brightness);
+        NeoPixelBus<NeoGrbFeature, TypeParam> bus(count);
+        NeoPixelBusOutput<TypeParam> output(bus);
+        output.Begin(brightness);
+
+        for (uint16_t i = 0; i < count; i++)
+        {
+            reference.SetPixel(i, colors[i]);
+            output.SetPixel(i, colors[i]);
+        }
+        for (uint16_t i = 0; i < count; i++)
+        {
+            EXPECT_EQ(adafruit.wireColor(i), Bytes(bus.GetPixelColor(i))) << "brightness " << brightness << ", color " << std::hex << colors[i];
+        }
+    }
+}
+
+TYPED_TEST(NeoPixelBusOutputTest, BeginClearsAndShowsEncodesTheFrame)
+{
+    NeoPixelBus<NeoGrbFeature, TypeParam> bus(3);
+    bus.SetPixelColor(1, RgbColor(9, 9, 9));
+    NeoPixelBusOutput<TypeParam> output(bus);
+    output.Begin(255);
+    EXPECT_EQ(3, output.Count());
+    EXPECT_EQ(0u, Bytes(bus.GetPixelColor(1)));
+    EXPECT_EQ(1u, bus.shows);
+
+    // green first on the wire, four encoded bytes for every byte of it
+    output.SetPixel(0, 0x00FF00);
+    output.SetPixel(3, 0xFFFFFF);
+    output.Show();
+    EXPECT_EQ(2u, bus.shows);
+    ASSERT_EQ(3u * 3 * 4, bus.Wire().size());
+    std::vector<uint8_t> ones(4, bus.Wire()[0]);
+    std::vector<uint8_t> zeros(4, bus.Wire()[4]);
+    EXPECT_NE(ones, zeros);
+    for (size_t i = 0; i < bus.Wire().size(); i++)
+    {
+        EXPECT_EQ(i < 4 ? ones[0] : zeros[0], bus.Wire()[i]) << i;
+    }
+}
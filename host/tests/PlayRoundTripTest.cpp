@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "SpotifyHost.h"
+
+namespace
+{
+    const char *const echo = "5fbb3ba6aa454b5534c4ba43a8c7e8e45a63ad0e";
+    const char *const pixel = "a4f2c0e19d7b3e1c55a0f4b6e2d8c9a17b3f0e21";
+
+    class PlayRoundTripTest : public ::testing::Test
+    {
+    protected:
+        SpotifyHost host;
+        SpotifyClient client{"client", "secret", "Echo en la Glasgow", "refresh-1"};
+        int tapResult = 0;
+
+        // what setup() does
+        void SetUp() override
+        {
+            client.FetchToken();
+            client.GetDevices();
+            ASSERT_TRUE(client.HasDevice());
+            host.api.ResetCounters();
+        }
+
+        void Tap(const char *uri)
+        {
+            tapResult = 0;
+            client.PlaySpotifyUriAsync(uri, [this](int httpCode)
+                                       { tapResult = httpCode; });
+            RunUntilIdle(client);
+        }
+
+        void Poll()
+        {
+            client.GetPlayerAsync();
+            RunUntilIdle(client);
+        }
+    };
+}
+
+TEST_F(PlayRoundTripTest, ShuffleRidesAlongWithPlay)
+{
+    Tap("spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ");
+
+    EXPECT_EQ(204, tapResult);
+    EXPECT_EQ(1, client.GetLastTapRoundTrips());
+    EXPECT_EQ(1u, host.api.plays);
+    EXPECT_EQ(1u, host.api.shuffles);
+    EXPECT_TRUE(host.api.shuffle);
+    EXPECT_EQ(echo, host.api.activeDevice);
+    // both went out on the connection GetDevices() left open
+    EXPECT_EQ(0u, host.api.connections);
+}
+
+TEST_F(PlayRoundTripTest, KnownShuffleIsNotSentAgain)
+{
+    Tap("spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ");
+    Tap("spotify:playlist:37i9dQZF1DXcBWIGoYBM5M");
+
+    EXPECT_EQ(1, client.GetLastTapRoundTrips());
+    EXPECT_EQ(2u, host.api.plays);
+    EXPECT_EQ(1u, host.api.shuffles);
+    EXPECT_EQ("spotify:playlist:37i9dQZF1DXcBWIGoYBM5M", host.api.context);
+}
+
+TEST_F(PlayRoundTripTest, PlayerStateOfThisDeviceConfirmsShuffle)
+{
+    host.api.StartOn(echo, "spotify:album:0", true);
+    Poll();
+    Tap("spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ");
+
+    EXPECT_EQ(1u, host.api.plays);
+    EXPECT_EQ(0u, host.api.shuffles);
+}
+
+TEST_F(PlayRoundTripTest, PlayerStateOfAnotherDeviceIsNotTrusted)
+{
+    Tap("spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ");
+    // the phone took over with shuffle on, the speaker's own state is unknown
+    host.api.StartOn(pixel, "spotify:album:0", true);
+    Poll();
+    Tap("spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ");
+
+    EXPECT_EQ(2u, host.api.plays);
+    EXPECT_EQ(2u, host.api.shuffles);
+    EXPECT_EQ(echo, host.api.activeDevice);
+}
+
+TEST_F(PlayRoundTripTest, StaleDeviceIdIsLookedUpAndPlayedAgain)
+{
+    Tap("spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ");
+    // the speaker came back with a new id
+    host.api.devices[0].id = "0b7ad0c6e15e4b0e8d2c1f3a9e6d5c4b3a2f1e0d";
+    Tap("spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ");
+
+    EXPECT_EQ(204, tapResult);
+    // play, devices, play again with shuffle
+    EXPECT_EQ(3, client.GetLastTapRoundTrips());
+    EXPECT_EQ(2u, host.api.plays);
+    EXPECT_EQ(2u, host.api.shuffles);
+    EXPECT_EQ("0b7ad0c6e15e4b0e8d2c1f3a9e6d5c4b3a2f1e0d", host.api.activeDevice);
+}
+
+TEST_F(PlayRoundTripTest, ExpiredTokenIsRefreshedAndPlayedAgain)
+{
+    host.api.acceptedToken = "token-2";
+    Tap("spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ");
+
+    EXPECT_EQ(204, tapResult);
+    // play, token, play again
+    EXPECT_EQ(3, client.GetLastTapRoundTrips());
+    // play and the shuffle written with it
+    EXPECT_EQ(2u, host.api.unauthorized);
+    EXPECT_EQ(2u, host.accounts.tokenRequests);
+    EXPECT_EQ(1u, host.api.plays);
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "PlaybackPoller.h"
+#include "SpotifyHost.h"
+
+namespace
+{
+    // as often as the sketch's scheduler looks whether a poll is due
+    const unsigned long checkInterval = 250;
+
+    class PlaybackPollerTest : public ::testing::Test
+    {
+    protected:
+        SpotifyHost host;
+        SpotifyClient client{"client", "secret", "Echo en la Glasgow", "refresh-1"};
+        PlaybackPoller poller{client};
+
+        unsigned long nextCheck = 0;
+        // what the mock last looked like, and since when
+        std::string seenTrack;
+        bool seenPlaying = false;
+        bool seenActive = false;
+        unsigned long changedAt = 0;
+        unsigned long changes = 0;
+        // how long after each change the poller reported it
+        std::vector<unsigned long> lags;
+
+        void SetUp() override
+        {
+            client.FetchToken();
+            client.GetDevices();
+            ASSERT_TRUE(client.HasDevice());
+            host.api.ResetCounters();
+            host.api.playerPolls = 0;
+        }
+
+        // the sketch's loop() a millisecond at a time up to until
+        void RunTo(unsigned long until)
+        {
+            while (millis() < until)
+            {
+                client.Loop();
+                Watch();
+                if ((long)(millis() - nextCheck) >= 0)
+                {
+                    nextCheck += checkInterval;
+                    if (poller.Update() != PlaybackNone)
+                    {
+                        lags.push_back(millis() - changedAt);
+                    }
+                }
+                Host::Advance(1000);
+            }
+        }
+
+        // notes when the mock changes in a way the poller should report
+        void Watch()
+        {
+            bool active = !host.api.activeDevice.empty();
+            std::string track = active ? host.api.TrackId() : std::string();
+            if (track != seenTrack || host.api.playing != seenPlaying || active != seenActive)
+            {
+                seenTrack = track;
+                seenPlaying = host.api.playing;
+                seenActive = active;
+                changedAt = millis();
+                changes++;
+            }
+        }
+    };
+}
+
+// An hour as the sketch sees it: a card starts an album of three and a half
+// minute tracks, 40 minutes in it is paused from the phone, ten minutes
+// later the speaker is switched off.
+TEST_F(PlaybackPollerTest, SimulatedHour)
+{
+    host.api.trackDurations = {210000};
+    RunTo(1000);
+    client.PlaySpotifyUriAsync("spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ", [this](int httpCode)
+                               { poller.Poke(); });
+    RunTo(40 * 60000);
+    host.api.PauseNow();
+    RunTo(50 * 60000);
+    host.api.activeDevice.clear();
+    RunTo(60 * 60000);
+
+    printf("%lu requests, %lu polls, %lu not modified, %lu errors, %lu bytes sent\n", host.api.requests, host.api.playerPolls,
+           host.api.notModified, poller.GetErrors(), host.api.bytesSent);
+    for (size_t i = 0; i < lags.size(); i++)
+    {
+        printf("change %zu seen after %lu ms\n", i, lags[i]);
+    }
+    RecordProperty("requests", (int)host.api.requests);
+    RecordProperty("not_modified", (int)host.api.notModified);
+
+    // the tap, then polls only, most of them answered with a bodiless 304
+    EXPECT_EQ(1u, host.api.plays);
+    EXPECT_EQ(poller.GetPolls(), host.api.playerPolls);
+    EXPECT_EQ(poller.GetNotModified(), host.api.notModified);
+    EXPECT_EQ(0u, poller.GetErrors());
+    // a poll every two seconds would be 1800
+    EXPECT_LE(host.api.requests, 150u);
+    EXPECT_GE(host.api.notModified, host.api.playerPolls * 3 / 4);
+
+    // the album starting, eleven track changes, the pause and the speaker
+    // going away, each seen once
+    EXPECT_EQ(14u, changes);
+    ASSERT_EQ(changes, lags.size());
+    // the tap is looked at again once Spotify has had a moment, a poll and a check later
+    EXPECT_LE(lags[0], (unsigned long)PLAYER_POLL_FAST + 2 * checkInterval);
+    // a track ending is looked for, the next one shows up within a check
+    for (size_t i = 1; i <= 11; i++)
+    {
+        EXPECT_LT(lags[i], checkInterval) << "track change " << i;
+    }
+    // changes from elsewhere wait for the poll, no longer than the ceiling
+    EXPECT_LE(lags[12], (unsigned long)PLAYER_POLL_PLAYING);
+    EXPECT_LE(lags[13], (unsigned long)PLAYER_POLL_IDLE);
+
+    // switched off, it settles at the idle ceiling
+    EXPECT_EQ((unsigned long)PLAYER_POLL_IDLE, poller.GetInterval());
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "Host.h"
+#include "Scheduler.h"
+
+namespace
+{
+    unsigned long ticks = 0;
+    unsigned long blocks = 0;
+
+    void Tick() { ticks++; }
+
+    // what a TLS handshake does to the loop
+    void Block()
+    {
+        blocks++;
+        Host::AdvanceMillis(30);
+    }
+
+    class SchedulerTest : public ::testing::Test
+    {
+    protected:
+        Scheduler scheduler;
+
+        void SetUp() override
+        {
+            Host::Reset();
+            ticks = 0;
+            blocks = 0;
+        }
+
+        // loop() passes a little apart, as long as the tasks take
+        void RunFor(unsigned long millis)
+        {
+            uint64_t end = Host::Now() + (uint64_t)millis * 1000;
+            while (Host::Now() <= end)
+            {
+                scheduler.Run();
+                Host::Advance(100);
+            }
+        }
+    };
+}
+
+TEST_F(SchedulerTest, PeriodicTaskStaysInPhase)
+{
+    TaskId id = scheduler.Every("tick", 5, Tick);
+    ASSERT_GE(id, 0);
+    RunFor(1000);
+
+    const TaskStats &stats = scheduler.GetTask(id)->stats;
+    EXPECT_EQ(200u, ticks);
+    EXPECT_EQ(200u, stats.runs);
+    EXPECT_EQ(0u, stats.maxLateness);
+}
+
+TEST_F(SchedulerTest, BlockingTaskShowsUpAsOthersLateness)
+{
+    TaskId tick = scheduler.Every("tick", 5, Tick);
+    TaskId block = scheduler.Every("block", 100, Block, 20000);
+    RunFor(1000);
+
+    const TaskStats &tickStats = scheduler.GetTask(tick)->stats;
+    const TaskStats &blockStats = scheduler.GetTask(block)->stats;
+    printf("tick: %lu runs, late avg %lu ms, max %lu ms; block: %lu overruns, max %lu us\n",
+           tickStats.runs, tickStats.totalLateness / tickStats.runs, tickStats.maxLateness, blockStats.overruns, blockStats.maxMicros);
+    EXPECT_EQ(10u, blocks);
+    EXPECT_EQ(10u, blockStats.overruns);
+    EXPECT_GE(blockStats.maxMicros, 30000u);
+    // held up by the whole block, then back in phase instead of running the missed ticks
+    EXPECT_GE(tickStats.maxLateness, 25u);
+    EXPECT_LT(tickStats.maxLateness, 35u);
+    EXPECT_LT(tickStats.runs, 200u);
+    EXPECT_EQ(0u, blockStats.maxLateness);
+}
+
+TEST_F(SchedulerTest, OneShotRunsOnce)
+{
+    TaskId id = scheduler.After("once", 50, Tick);
+    RunFor(49);
+    EXPECT_EQ(0u, ticks);
+    RunFor(200);
+    EXPECT_EQ(1u, ticks);
+    EXPECT_FALSE(scheduler.GetTask(id)->active);
+
+    // the slot is free again
+    EXPECT_EQ(id, scheduler.After("again", 10, Tick));
+}
+
+TEST_F(SchedulerTest, FullTableIsReported)
+{
+    for (int i = 0; i < SCHEDULER_MAX_TASKS; i++)
+    {
+        ASSERT_EQ(i, scheduler.Every("tick", 10, Tick));
+    }
+    EXPECT_EQ(-1, scheduler.Every("one too many", 10, Tick));
+    EXPECT_EQ(-1, scheduler.After("one too many", 10, Tick));
+
+    scheduler.Cancel(3);
+    EXPECT_EQ(3, scheduler.After("fits", 10, Tick));
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include "AudioSampler.h"
+#include "Spectrum.h"
+
+namespace
+{
+    // a frame of 10 bit readings around the microphone's mid-scale bias
+    void Sine(int16_t *frame, double hertz, double amplitude, double phase = 0)
+    {
+        for (int i = 0; i < FFT_SIZE; i++)
+        {
+            frame[i] = (int16_t)lround(512 + amplitude * sin(2 * M_PI * hertz * i / AUDIO_SAMPLE_RATE + phase));
+        }
+    }
+
+    int Loudest(const uint16_t *values, int count)
+    {
+        int loudest = 0;
+        for (int i = 1; i < count; i++)
+        {
+            if (values[i] > values[loudest])
+            {
+                loudest = i;
+            }
+        }
+        return loudest;
+    }
+
+    // the band a bin is folded into, as the band edges in Spectrum.cpp have it
+    int BandOf(int bin)
+    {
+        const int edges[SPECTRUM_BANDS + 1] = {1, 2, 3, 4, 5, 7, 9, 12, FFT_SIZE / 2};
+        for (int band = 0; band < SPECTRUM_BANDS; band++)
+        {
+            if (bin < edges[band + 1])
+            {
+                return band;
+            }
+        }
+        return -1;
+    }
+}
+
+TEST(Spectrum, SineLandsInItsBinAndBand)
+{
+    const double binWidth = (double)AUDIO_SAMPLE_RATE / FFT_SIZE;
+    int16_t frame[FFT_SIZE];
+    uint8_t levels[SPECTRUM_BANDS];
+    for (int bin = 1; bin < FFT_SIZE / 2; bin++)
+    {
+        Spectrum spectrum;
+        Sine(frame, bin * binWidth, 300, 0.3 * bin);
+        spectrum.Analyze(frame, levels);
+
+        EXPECT_EQ(bin, Loudest(spectrum.GetMagnitudes(), FFT_SIZE / 2)) << bin * binWidth << " Hz";
+        uint16_t levels16[SPECTRUM_BANDS];
+        std::copy(levels, levels + SPECTRUM_BANDS, levels16);
+        EXPECT_EQ(BandOf(bin), Loudest(levels16, SPECTRUM_BANDS)) << bin * binWidth << " Hz";
+        EXPECT_EQ(255, levels[BandOf(bin)]);
+        // the Hann window keeps the leak to the neighbouring bins
+        for (int other = 1; other < FFT_SIZE / 2; other++)
+        {
+            if (abs(other - bin) > 1)
+            {
+                EXPECT_LT(spectrum.GetBin(other), spectrum.GetBin(bin) / 16) << bin << " leaks into " << other;
+            }
+        }
+    }
+}
+
+TEST(Spectrum, MagnitudeFollowsAmplitude)
+{
+    Spectrum spectrum;
+    int16_t frame[FFT_SIZE];
+    uint8_t levels[SPECTRUM_BANDS];
+    const int bin = 6;
+    const double hertz = bin * (double)AUDIO_SAMPLE_RATE / FFT_SIZE;
+
+    Sine(frame, hertz, 400);
+    spectrum.Analyze(frame, levels);
+    uint16_t loud = spectrum.GetBin(bin);
+    Sine(frame, hertz, 100);
+    spectrum.Analyze(frame, levels);
+    uint16_t quiet = spectrum.GetBin(bin);
+
+    printf("bin %d: %u at amplitude 400, %u at 100\n", bin, loud, quiet);
+    EXPECT_NEAR(4.0, (double)loud / quiet, 0.2);
+    // levels are relative to the decaying peak, a quarter as loud right after a loud frame
+    EXPECT_NEAR(64, levels[BandOf(bin)], 8);
+}
+
+TEST(Spectrum, FullScaleDoesNotOverflow)
+{
+    Spectrum spectrum;
+    int16_t frame[FFT_SIZE];
+    uint8_t levels[SPECTRUM_BANDS];
+    // rails at 0 and 1023 as a clipping microphone gives them
+    for (int i = 0; i < FFT_SIZE; i++)
+    {
+        frame[i] = (i / 4) % 2 ? 1023 : 0;
+    }
+    spectrum.Analyze(frame, levels);
+    uint16_t square = spectrum.GetBin(FFT_SIZE / 8);
+
+    Sine(frame, AUDIO_SAMPLE_RATE / 8.0, 511);
+    spectrum.Analyze(frame, levels);
+    uint16_t sine = spectrum.GetBin(FFT_SIZE / 8);
+
+    // sampled four high, four low, a square's fundamental is 1.31 times its
+    // amplitude; a wrapped int16 anywhere would be far off
+    printf("square %u, sine %u\n", square, sine);
+    EXPECT_NEAR(1.31, (double)square / sine, 0.1);
+}
+
+TEST(Spectrum, SilenceIsDark)
+{
+    Spectrum spectrum;
+    int16_t frame[FFT_SIZE];
+    uint8_t levels[SPECTRUM_BANDS];
+    for (int i = 0; i < FFT_SIZE; i++)
+    {
+        // the bias with a count of ADC noise
+        frame[i] = 512 + (i % 3 == 0);
+    }
+    spectrum.Analyze(frame, levels);
+    for (int band = 0; band < SPECTRUM_BANDS; band++)
+    {
+        EXPECT_LT(levels[band], 32) << "band " << band;
+    }
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include <Adafruit_NeoPixel.h>
+#include "NeoPixelOutput.h"
+#include "SoundReactive.h"
+#include "StripGeometry.h"
+
+namespace
+{
+    // draws position i in color i + 1 and returns the strip's pixels
+    template <typename Geometry>
+    std::vector<uint32_t> DrawPositions()
+    {
+        Adafruit_NeoPixel strip(Geometry::count);
+        NeoPixelOutput output(strip);
+        StripLayout<Geometry, NeoPixelOutput> layout(output);
+        for (uint16_t position = 0; position < layout.Count(); position++)
+        {
+            layout.SetPixel(position, position + 1);
+        }
+        std::vector<uint32_t> pixels;
+        for (uint16_t i = 0; i < Geometry::count; i++)
+        {
+            pixels.push_back(strip.getPixelColor(i));
+        }
+        return pixels;
+    }
+}
+
+TEST(StripGeometry, RingTurnsAndWraps)
+{
+    // the sketch's ring, effects start one pixel in
+    std::vector<uint32_t> expected = {8, 1, 2, 3, 4, 5, 6, 7};
+    EXPECT_EQ(expected, (DrawPositions<StripGeometry<8, StripRing, 1>>()));
+    EXPECT_EQ(1u, (DrawPositions<StripGeometry<16, StripRing, 15>>()[15]));
+    EXPECT_EQ(60u, (DrawPositions<StripGeometry<60, StripRing, 30>>()[29]));
+}
+
+TEST(StripGeometry, LineRunsFromItsFirstPixel)
+{
+    std::vector<uint32_t> expected = {1, 2, 3, 4, 5};
+    EXPECT_EQ(expected, (DrawPositions<StripGeometry<5>>()));
+}
+
+TEST(StripGeometry, MirroredGrowsFromTheMiddle)
+{
+    std::vector<uint32_t> even = {4, 3, 2, 1, 1, 2, 3, 4};
+    EXPECT_EQ(even, (DrawPositions<StripGeometry<8, StripLine, 0, true>>()));
+    // an odd strip shares its middle pixel
+    std::vector<uint32_t> odd = {3, 2, 1, 2, 3};
+    EXPECT_EQ(odd, (DrawPositions<StripGeometry<5, StripLine, 0, true>>()));
+    // and a ring turns the whole of it
+    std::vector<uint32_t> ring = {3, 2, 1, 1, 2, 3};
+    std::rotate(ring.rbegin(), ring.rbegin() + 2, ring.rend());
+    EXPECT_EQ(ring, (DrawPositions<StripGeometry<6, StripRing, 2, true>>()));
+}
+
+TEST(StripGeometry, BandsSpreadEvenlyOverAnyStrip)
+{
+    constexpr PositionBands<60, SOUND_BANDS> sixty{};
+    int perBand[SOUND_BANDS] = {};
+    for (int position = 0; position < 60; position++)
+    {
+        perBand[sixty.band[position]]++;
+        if (position > 0)
+        {
+            EXPECT_GE(sixty.band[position], sixty.band[position - 1]);
+        }
+    }
+    for (int band = 0; band < SOUND_BANDS; band++)
+    {
+        EXPECT_GE(perBand[band], 7) << "band " << band;
+        EXPECT_LE(perBand[band], 8) << "band " << band;
+    }
+
+    // fewer positions than bands show every other band
+    constexpr PositionBands<4, SOUND_BANDS> four{};
+    EXPECT_EQ(0, four.band[0]);
+    EXPECT_EQ(6, four.band[3]);
+}
+
+TEST(StripGeometry, SoundReactiveDrawsEachBandWhereTheGeometrySaysSo)
+{
+    Adafruit_NeoPixel strip(16);
+    NeoPixelOutput output(strip);
+    StripLayout<StripGeometry<16, StripRing, 4, true>, NeoPixelOutput> layout(output);
+    SoundReactive sound;
+    const uint8_t levels[SOUND_BANDS] = {10, 40, 70, 100, 130, 160, 190, 250};
+    sound.Bands(levels);
+    sound.Render(layout);
+
+    // eight positions, one band each, either side of the middle of the turned ring
+    for (int position = 0; position < 8; position++)
+    {
+        EXPECT_EQ(AmplitudeColor(levels[position]), strip.getPixelColor((8 + position + 4) % 16)) << position;
+        EXPECT_EQ(AmplitudeColor(levels[position]), strip.getPixelColor((7 - position + 4) % 16)) << position;
+    }
+    EXPECT_EQ(1u, strip.shows);
+}
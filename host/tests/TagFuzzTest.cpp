@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include "NfcReader.h"
+#include "TagDump.h"
+#include "TagParser.h"
+
+// Mutation fuzzing of the NDEF parser and the TLV walk, seeded so a failure
+// comes back the same way. Inputs sit in buffers of their exact size: built
+// with -DHOST_SANITIZE=ON, AddressSanitizer stops at the first byte read
+// past the end.
+
+namespace
+{
+    std::vector<uint8_t> Record(uint8_t header, const std::string &type, const std::vector<uint8_t> &payload)
+    {
+        std::vector<uint8_t> record;
+        record.push_back(header);
+        record.push_back((uint8_t)type.size());
+        // short records have a one byte payload length, long ones four
+        for (int shift = header & 0x10 ? 0 : 24; shift >= 0; shift -= 8)
+        {
+            record.push_back((uint8_t)(payload.size() >> shift));
+        }
+        for (char c : type)
+        {
+            record.push_back((uint8_t)c);
+        }
+        for (uint8_t c : payload)
+        {
+            record.push_back(c);
+        }
+        return record;
+    }
+
+    std::vector<uint8_t> Bytes(const std::string &text) { return std::vector<uint8_t>(text.begin(), text.end()); }
+
+    // valid messages of every shape the parser understands
+    std::vector<std::vector<uint8_t>> Seeds()
+    {
+        std::vector<std::vector<uint8_t>> seeds;
+        seeds.push_back(UriRecord("https://open.spotify.com/album/1ay9Z4R5ZYI2TY7WiDhNYQ?si=a1b2c3"));
+        seeds.push_back(UriRecord("spotify:playlist:37i9dQZF1DXcBWIGoYBM5M"));
+        std::vector<uint8_t> text = {0x02, 'e', 'n'};
+        std::vector<uint8_t> link = Bytes("https://open.spotify.com/intl-de/track/4iV5W9uYEdYUVa79Axb7Rh");
+        text.insert(text.end(), link.begin(), link.end());
+        seeds.push_back(Record(0xD1, "T", text));
+        seeds.push_back(Record(0xC1, "U", Bytes("\x04open.spotify.com/artist/0OdUWJ0sBjDrqHygGUXeCF")));
+        seeds.push_back(Record(0xD3, "https://open.spotify.com/show/2MAi0BvDc6GTFvKFPXnkCL", {}));
+        std::vector<uint8_t> pair = Record(0x91, "U", Bytes("\x04spotify.link/abcdEFGH"));
+        std::vector<uint8_t> second = Record(0x51, "U", Bytes("\x04open.spotify.com/album/6dVIqQ8qmQ5GBnJ9shOYGE"));
+        pair.insert(pair.end(), second.begin(), second.end());
+        seeds.push_back(pair);
+        return seeds;
+    }
+
+    void Mutate(std::vector<uint8_t> &data, std::mt19937 &random)
+    {
+        int mutations = 1 + random() % 4;
+        for (int i = 0; i < mutations; i++)
+        {
+            size_t at = data.empty() ? 0 : random() % data.size();
+            switch (random() % 6)
+            {
+            case 0:
+                if (!data.empty())
+                    data[at] ^= 1 << (random() % 8);
+                break;
+            case 1:
+                if (!data.empty())
+                    data[at] = (uint8_t)random();
+                break;
+            case 2:
+                // lengths and headers are the interesting bytes, make them extreme
+                if (!data.empty())
+                    data[at] = random() % 2 ? 0xFF : 0x00;
+                break;
+            case 3:
+                data.resize(at);
+                break;
+            case 4:
+                data.insert(data.begin() + at, (uint8_t)random());
+                break;
+            default:
+                if (!data.empty())
+                {
+                    size_t from = random() % data.size();
+                    size_t count = random() % (data.size() - from + 1);
+                    std::vector<uint8_t> chunk(data.begin() + from, data.begin() + from + count);
+                    data.insert(data.begin() + at, chunk.begin(), chunk.end());
+                }
+                break;
+            }
+        }
+    }
+}
+
+TEST(TagFuzz, ParseTagUriStaysInBounds)
+{
+    std::vector<std::vector<uint8_t>> seeds = Seeds();
+    std::mt19937 random(12);
+    unsigned long parsed = 0;
+    for (int run = 0; run < 200000; run++)
+    {
+        std::vector<uint8_t> data = seeds[run % seeds.size()];
+        Mutate(data, random);
+        std::unique_ptr<uint8_t[]> message(new uint8_t[data.size()]);
+        std::copy(data.begin(), data.end(), message.get());
+
+        // output sizes down to what cannot even hold "spotify:"
+        size_t uriSize = run % 4 == 0 ? 1 + random() % 24 : NDEF_URI_SIZE;
+        std::unique_ptr<char[]> uri(new char[uriSize]);
+        memset(uri.get(), 0x5A, uriSize);
+        if (ParseTagUri(message.get(), data.size(), uri.get(), uriSize))
+        {
+            parsed++;
+            size_t length = strnlen(uri.get(), uriSize);
+            ASSERT_LT(length, uriSize) << "run " << run;
+            ASSERT_EQ(0, strncmp(uri.get(), "spotify:", 8)) << "run " << run;
+            ASSERT_GT(length, 8u) << "run " << run;
+            ASSERT_EQ(nullptr, strpbrk(uri.get(), "/?#")) << "run " << run;
+        }
+    }
+    printf("%lu of 200000 mutated messages still named something on Spotify\n", parsed);
+    EXPECT_GT(parsed, 0u);
+}
+
+TEST(TagFuzz, NfcReaderStaysInBounds)
+{
+    MFRC522 mfrc522(15, 0);
+    NfcReader nfc(mfrc522);
+    std::mt19937 random(21);
+    const HostTagType types[] = {Ultralight, Ntag213, Ntag215, Ntag216};
+    std::vector<std::vector<uint8_t>> seeds = Seeds();
+    for (int run = 0; run < 20000; run++)
+    {
+        HostTag tag = MakeTag(types[run % 4], seeds[run % seeds.size()]);
+        // scramble the TLV area from page 4 on, lengths included
+        std::vector<uint8_t> area(tag.memory.begin() + 16, tag.memory.begin() + std::min<size_t>(tag.memory.size(), 16 + 200));
+        Mutate(area, random);
+        area.resize(std::min(area.size(), tag.memory.size() - 16));
+        std::copy(area.begin(), area.end(), tag.memory.begin() + 16);
+
+        mfrc522.tag = &tag;
+        byte atqa[2];
+        byte atqaSize = sizeof(atqa);
+        mfrc522.PICC_WakeupA(atqa, &atqaSize);
+        ASSERT_TRUE(mfrc522.PICC_ReadCardSerial());
+        if (nfc.Read() == NfcOk)
+        {
+            ASSERT_LE(nfc.GetLength(), (size_t)NFC_BUFFER_SIZE) << "run " << run;
+            ASSERT_LE(nfc.GetMessage() + nfc.GetMessageLength(), nfc.GetData() + NFC_BUFFER_SIZE) << "run " << run;
+            char uri[NDEF_URI_SIZE];
+            ParseTagUri(nfc.GetMessage(), nfc.GetMessageLength(), uri, sizeof(uri));
+        }
+        // never more than the whole buffer in single reads plus a fallback
+        ASSERT_LE(nfc.GetTransactions(), NFC_BUFFER_SIZE / (NFC_READ_PAGES * NFC_PAGE_SIZE) + 4) << "run " << run;
+    }
+}
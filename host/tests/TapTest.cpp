@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "SpotifyHost.h"
+#include "TapReference.h"
+
+namespace
+{
+    class TapTest : public ::testing::Test
+    {
+    protected:
+        SpotifyHost host;
+        SpotifyClient client{"client", "secret", "Echo en la Glasgow", "refresh-1"};
+        const String album = "spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ";
+        const String playlist = "spotify:playlist:37i9dQZF1DXcBWIGoYBM5M";
+        std::vector<std::pair<int, int>> finished;
+
+        void SetUp() override
+        {
+            client.FetchToken();
+            client.GetDevices();
+            ASSERT_TRUE(client.HasDevice());
+        }
+
+        void Tap(int tap, const String &uri)
+        {
+            client.PlaySpotifyUriAsync(uri, [this, tap](int httpCode)
+                                       { finished.push_back(std::make_pair(tap, httpCode)); });
+        }
+
+        // String copies of a tap through the old path, its requests answered
+        // in queue order with codes
+        unsigned long ReferenceCopies(const String &uri, std::vector<int> codes)
+        {
+            ReferenceTapPath reference;
+            int result = 0;
+            unsigned long copies = String::copies;
+            reference.PlaySpotifyUriAsync(uri, [&result](int httpCode)
+                                          { result = httpCode; });
+            for (int code : codes)
+            {
+                EXPECT_TRUE(reference.Answer(code));
+            }
+            copies = String::copies - copies;
+            EXPECT_EQ(0, reference.Queued());
+            EXPECT_EQ(204, result);
+            return copies;
+        }
+    };
+}
+
+TEST_F(TapTest, SecondTapReplacesTheFirst)
+{
+    unsigned long playsWhenDone = 0;
+    Tap(1, album);
+    client.PlaySpotifyUriAsync(playlist, [&](int httpCode)
+                               { playsWhenDone = host.api.plays; finished.push_back(std::make_pair(2, httpCode)); });
+    RunUntilIdle(client);
+
+    // the first play was already queued and goes out, only the second reports
+    // and only once its own play is answered
+    ASSERT_EQ(1u, finished.size());
+    EXPECT_EQ(2, finished[0].first);
+    EXPECT_EQ(204, finished[0].second);
+    EXPECT_EQ(2u, playsWhenDone);
+    EXPECT_EQ(playlist.c_str(), host.api.context);
+}
+
+TEST_F(TapTest, ReplacedTapIsNotRetried)
+{
+    // the speaker came back with a new id, both plays are answered with 404
+    host.api.devices[0].id = "0b7ad0c6e15e4b0e8d2c1f3a9e6d5c4b3a2f1e0d";
+    Tap(1, album);
+    Tap(2, playlist);
+    RunUntilIdle(client);
+
+    ASSERT_EQ(1u, finished.size());
+    EXPECT_EQ(2, finished[0].first);
+    EXPECT_EQ(204, finished[0].second);
+    ASSERT_EQ(1u, host.api.playedUris.size());
+    EXPECT_EQ(playlist.c_str(), host.api.playedUris[0]);
+}
+
+TEST_F(TapTest, TapMakesNoStringCopies)
+{
+    // the play and the shuffle behind it, then the same after a 404 and a
+    // 401: the devices or the token, and both again
+    unsigned long plainBefore = ReferenceCopies(album, {204, 204});
+    unsigned long newDeviceBefore = ReferenceCopies(playlist, {404, 204, 200, 204, 204});
+    unsigned long newTokenBefore = ReferenceCopies(album, {401, 204, 200, 204, 204});
+
+    unsigned long copies = String::copies;
+    Tap(1, album);
+    RunUntilIdle(client);
+    unsigned long plain = String::copies - copies;
+
+    // the speaker came back with a new id
+    host.api.devices[0].id = "0b7ad0c6e15e4b0e8d2c1f3a9e6d5c4b3a2f1e0d";
+    copies = String::copies;
+    Tap(2, playlist);
+    RunUntilIdle(client);
+    unsigned long newDevice = String::copies - copies;
+
+    host.api.acceptedToken = "token-2";
+    copies = String::copies;
+    Tap(3, album);
+    RunUntilIdle(client);
+    unsigned long newToken = String::copies - copies;
+
+    printf("String copies per tap %lu, before %lu\n", plain, plainBefore);
+    printf("after a 404 %lu, before %lu\n", newDevice, newDeviceBefore);
+    printf("after a 401 %lu, before %lu plus the token\n", newToken, newTokenBefore);
+    RecordProperty("copies_per_tap", (int)plain);
+    RecordProperty("copies_per_tap_before", (int)plainBefore);
+    ASSERT_EQ(3u, finished.size());
+    EXPECT_EQ(204, finished[1].second);
+    EXPECT_EQ(204, finished[2].second);
+    EXPECT_EQ(0u, plain);
+    EXPECT_EQ(0u, newDevice);
+    // the new token itself, copied into the buffer the old one had rather
+    // than moved, which would leave the listener to allocate a new one
+    EXPECT_EQ(1u, newToken);
+
+    // the URI went by value down every call and rode along in every callback
+    EXPECT_GT(plainBefore, 0u);
+    EXPECT_GT(newDeviceBefore, plainBefore);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "FakeClock.h"
+#include "SpotifyHost.h"
+
+namespace
+{
+    class TokenRefreshTest : public ::testing::Test
+    {
+    protected:
+        SpotifyHost host;
+        FakeClock clock;
+        SpotifyClient client{"client", "secret", "Echo en la Glasgow", "refresh-1", clock};
+
+        // what setup() does
+        void SetUp() override
+        {
+            client.FetchToken();
+            ASSERT_EQ(1u, host.accounts.tokenRequests);
+            ASSERT_TRUE(client.HasToken());
+        }
+    };
+}
+
+TEST_F(TokenRefreshTest, RefreshesAheadOfExpiryOnly)
+{
+    EXPECT_EQ("refresh-1", host.accounts.lastRefreshToken);
+    EXPECT_EQ("Basic Y2xpZW50OnNlY3JldA==", host.accounts.lastAuthorization);
+
+    clock.now = 3600000 - TOKEN_REFRESH_MARGIN - 1;
+    RunUntilIdle(client);
+    EXPECT_EQ(1u, host.accounts.tokenRequests);
+
+    clock.Advance(1);
+    RunUntilIdle(client);
+    EXPECT_EQ(2u, host.accounts.tokenRequests);
+
+    // the new token counts from when it was asked for
+    clock.Advance(3600000 - TOKEN_REFRESH_MARGIN - 1);
+    RunUntilIdle(client);
+    EXPECT_EQ(2u, host.accounts.tokenRequests);
+}
+
+TEST_F(TokenRefreshTest, ShorterLifetimeFromExpiresIn)
+{
+    host.accounts.expiresIn = 600;
+    clock.now = 3600000 - TOKEN_REFRESH_MARGIN;
+    RunUntilIdle(client);
+    ASSERT_EQ(2u, host.accounts.tokenRequests);
+
+    clock.Advance(600000 - TOKEN_REFRESH_MARGIN);
+    RunUntilIdle(client);
+    EXPECT_EQ(3u, host.accounts.tokenRequests);
+}
+
+TEST_F(TokenRefreshTest, FailedRefreshIsRetriedAfterTheInterval)
+{
+    host.accounts.status = 500;
+    clock.now = 3600000 - TOKEN_REFRESH_MARGIN;
+    RunUntilIdle(client);
+    ASSERT_EQ(2u, host.accounts.tokenRequests);
+
+    clock.Advance(TOKEN_RETRY_INTERVAL - 1);
+    RunUntilIdle(client);
+    EXPECT_EQ(2u, host.accounts.tokenRequests);
+
+    host.accounts.status = 200;
+    clock.Advance(1);
+    RunUntilIdle(client);
+    EXPECT_EQ(3u, host.accounts.tokenRequests);
+    EXPECT_EQ(host.accounts.CurrentToken(), "token-2");
+}
+
+TEST_F(TokenRefreshTest, RotatedRefreshTokenIsUsedNextTime)
+{
+    host.accounts.rotatedRefreshToken = "refresh-2";
+    clock.now = 3600000 - TOKEN_REFRESH_MARGIN;
+    RunUntilIdle(client);
+    clock.Advance(3600000 - TOKEN_REFRESH_MARGIN);
+    RunUntilIdle(client);
+    ASSERT_EQ(3u, host.accounts.tokenRequests);
+    EXPECT_EQ("refresh-2", host.accounts.lastRefreshToken);
+}
+
+TEST_F(TokenRefreshTest, TapWithADeadTokenRefreshesFirst)
+{
+    client.GetDevices();
+    ASSERT_TRUE(client.HasDevice());
+    host.api.acceptedToken = "token-2";
+
+    // the device was off long enough for Loop() to never get a chance
+    clock.Advance(2 * 3600000);
+    int result = 0;
+    client.PlaySpotifyUriAsync("spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ", [&result](int httpCode)
+                               { result = httpCode; });
+    RunUntilIdle(client);
+    EXPECT_EQ(204, result);
+    EXPECT_EQ(2u, host.accounts.tokenRequests);
+    EXPECT_EQ(1u, host.api.plays);
+    // the token went first, no 401 round trip
+    EXPECT_EQ(0u, host.api.unauthorized);
+}
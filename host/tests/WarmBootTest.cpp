@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <FS.h>
+#include "FakeClock.h"
+#include "SpotifyHost.h"
+
+namespace
+{
+    class WarmBootTest : public ::testing::Test
+    {
+    protected:
+        SpotifyHost host;
+        FakeClock clock;
+        fs::FS store;
+
+        // the first boot ever, what setup() does with nothing stored
+        void SetUp() override
+        {
+            ASSERT_TRUE(store.begin());
+            SpotifyClient cold("client", "secret", "Echo en la Glasgow", "refresh-1", clock);
+            cold.SetStore(&store);
+            cold.FetchToken();
+            cold.GetDevices();
+            ASSERT_TRUE(cold.HasDevice());
+            host.accounts.ResetCounters();
+            host.api.ResetCounters();
+        }
+    };
+}
+
+TEST_F(WarmBootTest, StoredTokenIsReplacedOnTheFirstLoop)
+{
+    clock.now = 4000;
+    SpotifyClient warm("client", "secret", "Echo en la Glasgow", "refresh-1", clock);
+    warm.SetStore(&store);
+    EXPECT_TRUE(warm.HasToken());
+    EXPECT_TRUE(warm.HasDevice());
+
+    warm.Loop();
+    RunUntilIdle(warm);
+    EXPECT_EQ(1u, host.accounts.requests);
+    EXPECT_EQ(2u, host.accounts.tokenRequests);
+
+    // the fresh token is good for its full hour
+    clock.Advance(3600000 - TOKEN_REFRESH_MARGIN - 1);
+    RunUntilIdle(warm);
+    EXPECT_EQ(2u, host.accounts.tokenRequests);
+}
+
+TEST_F(WarmBootTest, TapRightAfterBootUsesTheStoredToken)
+{
+    clock.now = 4000;
+    SpotifyClient warm("client", "secret", "Echo en la Glasgow", "refresh-1", clock);
+    warm.SetStore(&store);
+    host.api.acceptedToken = host.accounts.CurrentToken();
+
+    int result = 0;
+    warm.PlaySpotifyUriAsync("spotify:album:1ay9Z4R5ZYI2TY7WiDhNYQ", [&](int httpCode)
+                             { result = httpCode; });
+    RunUntilIdle(warm);
+
+    EXPECT_EQ(204, result);
+    EXPECT_EQ(1u, host.api.plays);
+    EXPECT_EQ(0u, host.api.unauthorized);
+    // no devices lookup either, the stored id was good
+    EXPECT_EQ(host.api.plays + host.api.shuffles, host.api.requests);
+}